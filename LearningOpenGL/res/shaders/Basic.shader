@@ -1,31 +1,46 @@
 #shader vertex
 #version 330 core
+#ifdef GL_SPIRV
+#extension GL_ARB_explicit_uniform_location : require // Each stage is its own module, so default-block uniforms need locations that don't clash
+#endif
 
 layout(location = 0) in vec4 position;
 layout(location = 1) in vec2 texCoord;
 
 out vec2 v_TexCoord;
 
+#ifdef GL_SPIRV
+layout(location = 0)
+#endif
 uniform mat4 u_MVP;
 
 void main()
 {
     gl_Position = u_MVP * position;
     v_TexCoord = texCoord;
-};
+}
 
 #shader fragment
 #version 330 core
+#ifdef GL_SPIRV
+#extension GL_ARB_explicit_uniform_location : require
+#endif
 
 layout(location = 0) out vec4 color;
 
 in vec2 v_TexCoord;
 
+#ifdef GL_SPIRV
+layout(location = 1)
+#endif
 uniform vec4 u_Color;
+#ifdef GL_SPIRV
+layout(location = 2)
+#endif
 uniform sampler2D u_Texture;
 
 void main()
 {
     vec4 texColor = texture(u_Texture, v_TexCoord);
     color = texColor;
-};
+}
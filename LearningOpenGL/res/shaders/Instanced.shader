@@ -0,0 +1,31 @@
+#shader vertex
+#version 330 core
+
+layout(location = 0) in vec4 position;
+layout(location = 1) in vec2 texCoord;
+layout(location = 2) in mat4 instanceModel; // Per-instance, takes up locations 2 to 5
+
+out vec2 v_TexCoord;
+
+#include "include/Camera.glsl"
+
+void main()
+{
+    gl_Position = u_ViewProjection * instanceModel * position;
+    v_TexCoord = texCoord;
+}
+
+#shader fragment
+#version 330 core
+
+layout(location = 0) out vec4 color;
+
+in vec2 v_TexCoord;
+
+uniform sampler2D u_Texture;
+
+void main()
+{
+    vec4 texColor = texture(u_Texture, v_TexCoord);
+    color = texColor;
+}
@@ -0,0 +1,17 @@
+#shader compute
+#version 430 core
+
+layout(local_size_x = 8, local_size_y = 8) in;
+
+layout(rgba8, binding = 0) uniform readonly image2D u_Source;
+layout(rgba8, binding = 1) uniform writeonly image2D u_Destination;
+
+void main()
+{
+    ivec2 texel = ivec2(gl_GlobalInvocationID.xy);
+    if (any(greaterThanEqual(texel, imageSize(u_Source))))
+        return;
+
+    vec4 color = imageLoad(u_Source, texel);
+    imageStore(u_Destination, texel, vec4(1.0 - color.rgb, color.a));
+}
@@ -0,0 +1,55 @@
+#shader vertex
+#version 330 core
+#ifdef GL_SPIRV
+#extension GL_ARB_explicit_uniform_location : require // Each stage is its own module, so default-block uniforms need locations that don't clash
+#endif
+
+layout(location = 0) in vec4 position;
+layout(location = 1) in vec2 texCoord;
+
+out vec2 v_TexCoord;
+flat out vec4 v_Color;
+
+#include "include/Camera.glsl"
+#include "include/Draw.glsl"
+
+void main()
+{
+    DrawData draw = u_Draws[u_DrawIndex];
+    gl_Position = u_ViewProjection * draw.Model * position;
+    v_TexCoord = texCoord;
+    v_Color = draw.Color;
+}
+
+#shader fragment
+#version 330 core
+#ifdef GL_SPIRV
+#extension GL_ARB_explicit_uniform_location : require
+#endif
+
+layout(location = 0) out vec4 color;
+
+in vec2 v_TexCoord;
+flat in vec4 v_Color;
+
+#ifdef GL_SPIRV
+layout(constant_id = 0) const bool TEXTURED = false; // SPIR-V variants are specialized rather than #defined, see ShaderSpirv
+#endif
+
+#if defined(TEXTURED) || defined(GL_SPIRV)
+#ifdef GL_SPIRV
+layout(location = 1)
+#endif
+uniform sampler2D u_Texture;
+#endif
+
+void main()
+{
+#ifdef GL_SPIRV
+    color = TEXTURED ? texture(u_Texture, v_TexCoord) * v_Color : v_Color;
+#elif defined(TEXTURED)
+    color = texture(u_Texture, v_TexCoord) * v_Color;
+#else
+    color = v_Color;
+#endif
+}
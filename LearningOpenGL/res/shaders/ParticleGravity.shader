@@ -0,0 +1,20 @@
+#shader compute
+#version 430 core
+
+layout(local_size_x = 64) in;
+
+#include "include/Particles.glsl"
+
+uniform float u_Gravity;
+uniform float u_DeltaTime;
+
+void main()
+{
+    atomicAdd(launched, 1u);
+
+    uint slot = gl_GlobalInvocationID.x;
+    if (slot >= aliveCount) // The last group is only partly used
+        return;
+
+    particles[alive[slot]].Velocity.y -= u_Gravity * u_DeltaTime;
+}
@@ -0,0 +1,30 @@
+#shader compute
+#version 430 core
+
+layout(local_size_x = 64) in;
+
+#include "include/Particles.glsl"
+
+uniform int u_Count;
+uniform float u_DeltaTime;
+
+void main()
+{
+    uint index = gl_GlobalInvocationID.x;
+    if (index >= uint(u_Count) || particles[index].Position.w == 0.0)
+        return;
+
+    Particle particle = particles[index];
+    particle.Position.xyz += particle.Velocity.xyz * u_DeltaTime;
+    if (particle.Position.y < 0.0) // Fell through the floor
+        particle.Position.w = 0.0;
+    particles[index] = particle;
+    if (particle.Position.w == 0.0)
+        return;
+
+    // Survivors go on the list for ParticleGravity, one more work group for every 64 of them
+    uint slot = atomicAdd(aliveCount, 1u);
+    alive[slot] = index;
+    if (slot % 64u == 0u)
+        atomicAdd(groupsX, 1u);
+}
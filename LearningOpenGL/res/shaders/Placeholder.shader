@@ -0,0 +1,25 @@
+#shader vertex
+#version 330 core
+#ifdef GL_SPIRV
+#extension GL_ARB_explicit_uniform_location : require
+#endif
+
+layout(location = 0) in vec4 position;
+
+#include "include/Camera.glsl"
+#include "include/Draw.glsl"
+
+void main()
+{
+    gl_Position = u_ViewProjection * u_Draws[u_DrawIndex].Model * position;
+}
+
+#shader fragment
+#version 330 core
+
+layout(location = 0) out vec4 color;
+
+void main()
+{
+    color = vec4(1.0, 0.0, 1.0, 1.0); // ResourceManager hands this out for shaders that failed, it should stand out
+}
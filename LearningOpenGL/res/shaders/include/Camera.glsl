@@ -0,0 +1,8 @@
+// CameraBlock, bound to UniformBinding::Camera
+layout(std140) uniform Camera
+{
+    mat4 u_ViewProjection;
+    mat4 u_View;
+    mat4 u_Projection;
+    vec4 u_CameraPosition;
+};
@@ -0,0 +1,18 @@
+// DrawBlock array, bound to UniformBinding::Draw and streamed by Renderer::Draw. Vertex stages only, the
+// including stage needs GL_ARB_explicit_uniform_location under GL_SPIRV for u_DrawIndex's location
+struct DrawData
+{
+    mat4 Model;
+    vec4 Color;
+    ivec4 Material;
+};
+
+layout(std140) uniform Draw // MaxDrawBlocks long
+{
+    DrawData u_Draws[128];
+};
+
+#ifdef GL_SPIRV
+layout(location = 0)
+#endif
+uniform int u_DrawIndex;
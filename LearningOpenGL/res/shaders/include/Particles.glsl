@@ -0,0 +1,25 @@
+// Buffers shared by ParticleUpdate.shader and ParticleGravity.shader, laid out as in ComputeCheck.cpp
+struct Particle
+{
+    vec4 Position; // w is 1 while alive, 0 once dead
+    vec4 Velocity;
+};
+
+layout(std430, binding = 0) buffer Particles
+{
+    Particle particles[];
+};
+
+layout(std430, binding = 1) buffer Counters // Starts with the DispatchIndirectCommand ParticleGravity is dispatched with
+{
+    uint groupsX;
+    uint groupsY;
+    uint groupsZ;
+    uint aliveCount;
+    uint launched; // Threads ParticleGravity ran, alive ones or not
+};
+
+layout(std430, binding = 2) buffer AliveList
+{
+    uint alive[]; // Indices into particles, aliveCount long, in no particular order
+};
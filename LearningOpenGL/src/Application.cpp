@@ -3,50 +3,214 @@
 
 #include "GLPrerequisites.h"
 
+#include <chrono>
 #include <iostream>
 #include <fstream>
 #include <string>
 #include <sstream>
-
+#include <cstdlib>
+#include <memory>
+#include <vector>
+
+#include "CPUProfiler.h"
+#include "GLState.h"
+#include "Framebuffer.h"
+#include "FrameCapture.h"
+#include "ComputeCheck.h"
+#include "GLCallBenchmark.h"
+#include "GPUProfiler.h"
+#include "HeadlessContext.h"
+#include "ImageWriter.h"
+#include "ImageCompare.h"
+#include "ShaderCache.h"
+#include "ShaderSpirv.h"
 #include "Renderer.h"
+#include "ResourceManager.h"
 #include "VertexBuffer.h"
 #include "IndexBuffer.h"
 #include "VertexArray.h"
 #include "Shader.h"
 #include "Texture.h"
+#include "TextureCompressor.h"
+#include "UniformBuffer.h"
 
 #include "glm.hpp"
 #include "gtc/matrix_transform.hpp"
 
-int main(void)
+int main(int argc, char* argv[])
 {
-    GLFWwindow* window;
+    // Usage: LearningOpenGL [--headless] [--frames N] [--capture file.png|file.raw] [--compare reference.png] [--tolerance N] [--gl-sync] [--no-shader-cache] [--spirv] [--bench-glcall] [--compute-check] [--trace file.json]
+    //        LearningOpenGL --export-glsl directory file.shader... (used by the CompileSpirv build target, needs no GL)
+    //        LearningOpenGL --compress-textures BC1|BC3|BC4|BC5|BC7 directory file.png... (used by the CompressTextures build target, needs no GL)
+    bool headless = false; // No window, renders into a Framebuffer and writes the last frame to disk
+    int headlessFrames = 1;
+    std::string capturePath = "capture.png";
+    std::string comparePath; // The captured frame is checked against this image, a mismatch makes the exit code 1
+    int compareTolerance = 8; // Per-channel difference allowed before a pixel counts as different
+#if GLCALL_MODE == GLCALL_MODE_DEBUG
+    bool debugSynchronous = false; // Makes the KHR_debug callback fire inside the failing call
+#endif
+    bool shaderCache = true; // Linked programs are kept in shadercache/ between runs
+    bool benchGLCall = false; // Runs the GLCall overhead benchmark and exits
+    bool computeCheck = false; // Runs the compute samples against CPU results and exits, 1 if any of them is wrong
+    std::string tracePath; // CPU zones are written here as a Chrome trace (chrome://tracing, Perfetto) on exit
+    bool spirv = false; // Programs come from the SPIR-V in res/shaders/spirv where there is some, GLSL otherwise
+    std::string exportDirectory; // Writes every stage of the listed .shader files out as plain GLSL and exits
+    std::vector<std::string> exportFiles;
+    std::string compressFormat; // Writes each listed image as <directory>/<name>.dds in this format and exits
+    std::string compressDirectory;
+    std::vector<std::string> compressFiles;
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        if (arg == "--headless")
+            headless = true;
+        else if (arg == "--frames" && i + 1 < argc)
+            headlessFrames = std::atoi(argv[++i]);
+        else if (arg == "--capture" && i + 1 < argc)
+            capturePath = argv[++i];
+        else if (arg == "--compare" && i + 1 < argc)
+            comparePath = argv[++i];
+        else if (arg == "--tolerance" && i + 1 < argc)
+            compareTolerance = std::atoi(argv[++i]);
+#if GLCALL_MODE == GLCALL_MODE_DEBUG
+        else if (arg == "--gl-sync")
+            debugSynchronous = true;
+#endif
+        else if (arg == "--no-shader-cache")
+            shaderCache = false;
+        else if (arg == "--bench-glcall")
+            benchGLCall = true;
+        else if (arg == "--compute-check")
+            computeCheck = true;
+        else if (arg == "--trace" && i + 1 < argc)
+            tracePath = argv[++i];
+        else if (arg == "--spirv")
+            spirv = true;
+        else if (arg == "--export-glsl" && i + 1 < argc)
+        {
+            exportDirectory = argv[++i];
+            exportFiles.assign(argv + i + 1, argv + argc);
+            break;
+        }
+        else if (arg == "--compress-textures" && i + 2 < argc)
+        {
+            compressFormat = argv[++i];
+            compressDirectory = argv[++i];
+            compressFiles.assign(argv + i + 1, argv + argc);
+            break;
+        }
+    }
+
+    if (!exportDirectory.empty())
+    {
+        bool exported = true;
+        for (const std::string& file : exportFiles)
+            exported &= ShaderSpirv::ExportGLSL(file, exportDirectory);
+        return exported ? 0 : 1;
+    }
+
+    if (!compressFormat.empty())
+    {
+        CompressedFormat format;
+        if (!TextureContainer::ParseName(compressFormat, format))
+        {
+            std::cout << "Unknown texture format '" << compressFormat << "'!" << std::endl;
+            return 1;
+        }
 
-    if (!glfwInit()) // Initialize the library
-        return -1;
+        bool compressed = true;
+        for (const std::string& file : compressFiles)
+        {
+            size_t start = file.find_last_of("/\\") + 1, dot = file.find_last_of('.');
+            std::string name = file.substr(start, dot == std::string::npos || dot < start ? std::string::npos : dot - start);
+            compressed &= TextureCompressor::CompressFile(file, compressDirectory + "/" + name + ".dds", format);
+        }
+        return compressed ? 0 : 1;
+    }
 
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
-    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    GLFWwindow* window = nullptr;
+    HeadlessContext headlessContext;
 
-    window = glfwCreateWindow(960, 540, "GOJO", NULL, NULL); // Create a windowed mode window and its OpenGL context
-    if (!window)
+    if (headless)
     {
-        glfwTerminate();
-        return -1;
+        if (!headlessContext.Create(GLContextVersions, GLContextVersionCount))
+            return -1;
     }
+    else
+    {
+        if (!glfwInit()) // Initialize the library
+            return -1;
+
+        glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+#if GLCALL_MODE == GLCALL_MODE_DEBUG
+        glfwWindowHint(GLFW_OPENGL_DEBUG_CONTEXT, GLFW_TRUE);
+#endif
+
+        for (unsigned int i = 0; i < GLContextVersionCount && !window; i++) // Newest first, falls back down to 3.3
+        {
+            glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, GLContextVersions[i].Major);
+            glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, GLContextVersions[i].Minor);
+            window = glfwCreateWindow(960, 540, "GOJO", NULL, NULL); // Create a windowed mode window and its OpenGL context
+        }
+        if (!window)
+        {
+            glfwTerminate();
+            return -1;
+        }
 
-    glfwMakeContextCurrent(window); // Make the window's context current
+        glfwMakeContextCurrent(window); // Make the window's context current
 
-    glfwSwapInterval(1);
+        glfwSwapInterval(1);
+    }
 
-    if (glewInit() != GLEW_OK) // initialses glew AFTER glfw creates a current context
+    GLenum glewStatus = glewInit(); // initialses glew AFTER a context is current
+    if (glewStatus != GLEW_OK && !(headless && glewStatus == GLEW_ERROR_NO_GLX_DISPLAY)) // GLX builds of GLEW find no display under EGL, the GL functions are loaded by then anyway
     {
         std::cout << "ERROR!" << std::endl;
     }
 
+#if GLCALL_MODE == GLCALL_MODE_DEBUG
+    GLEnableDebugOutput(debugSynchronous);
+#endif
+
     std::cout << glGetString(GL_VERSION) << std::endl; // Displays OpenGL version in console
+
+    if (benchGLCall)
+    {
+        GLDisableDebugOutput();
+        RunGLCallBenchmark();
+        if (!headless)
+            glfwTerminate();
+        return 0;
+    }
+
+    if (computeCheck)
+    {
+        bool passed = RunComputeCheck();
+        if (!headless)
+            glfwTerminate();
+        return passed ? 0 : 1;
+    }
+
+    if (shaderCache)
+        ShaderCache::Init("shadercache");
+    if (spirv)
+        ShaderSpirv::Init("res/shaders/spirv");
+
+    bool compareFailed = false;
     {
+        std::unique_ptr<Framebuffer> offscreen; // Created first, it binds textures while setting up
+        if (headless)
+        {
+            offscreen = std::make_unique<Framebuffer>(960, 540);
+            offscreen->Bind();
+        }
+
+        ResourceManager resources; // Compiles and decodes in the background while the buffers are set up, each file once however often it's asked for
+        ShaderRef shaderRef = resources.LoadShader("res/shaders/Object.shader", { "TEXTURED" });
+        TextureRef textureRef = resources.LoadTexture("res/textures/GojoTexture256x256.png");
+
         float vertexData[16] // Defining a vertex buffer
         {
              -128.0f,  -128.0f,         0.0f,  0.0f,    // 0
@@ -61,8 +225,8 @@ int main(void)
             2, 3, 0
         };
 
-        GLCall(glEnable(GL_BLEND));
-        GLCall(glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA));
+        GLState::SetBlend(true);
+        GLState::BlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
         VertexArray vao;
 
@@ -75,41 +239,80 @@ int main(void)
 
         IndexBuffer ibo(indices, 6);
 
-        Shader shader("res/shaders/Basic.shader");
+        while (resources.Poll() > 0) // Loading screen, keeps the window responsive until every program is linked and texture uploaded
+        {
+            if (headless)
+                continue;
+            GLCall(glClear(GL_COLOR_BUFFER_BIT));
+            glfwSwapBuffers(window);
+            glfwPollEvents();
+        }
+        if (!resources.IsLoaded(shaderRef))
+            std::cout << "Failed to load 'res/shaders/Object.shader', drawing with the placeholder shader" << std::endl;
+        const Shader& shader = resources.Get(shaderRef);
+        const Texture& texture = resources.Get(textureRef);
+        texture.Bind(0);
+
         shader.Bind();
         // shader.SetUniform4f("u_Color", 0.8f, 0.3f, 0.8f, 1.0f);
-
-        Texture texture("res/textures/GojoTexture256x256.png");
-        texture.Bind(0);
-        shader.SetUniform1i("u_Texture", 0);
+        shader.SetUniform(shader.GetUniform("u_Texture"), 0);
 
         glm::mat4 projMat = glm::ortho(0.0f, 960.0f, 0.0f, 540.0f, -1.0f, 1.0f); // PROJECTION MATRIX (normalises positions to screen-space coordinates)
         glm::mat4 viewMat = glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, 0.0f, 0.0f)); // VIEW MATRIX (position of camera but inverse?)
         glm::mat4 modelMat = glm::translate(glm::mat4(1.0f), glm::vec3(480.0f, 270.0f, 0.0f)); // MODEL MATRIX (position of model)
 
-        glm::mat4 mvpMat = projMat * viewMat * modelMat;
-
-        shader.SetUniformMat4f("u_MVP", mvpMat);
-
         vao.Unbind();
         vbo.Unbind();
         ibo.Unbind();
         shader.Unbind();
 
         Renderer renderer;
+        GPUProfiler profiler;
+        renderer.SetProfiler(&profiler);
+
+        RingBuffer drawData(GL_UNIFORM_BUFFER, 64 * 1024); // Per-draw DrawBlocks, room for a few hundred draws a frame
+        renderer.SetDrawData(&drawData);
+
+        UniformBuffer cameraBuffer(sizeof(CameraBlock), UniformBinding::Camera); // Shared by every program that declares the block
+        UniformBuffer frameBuffer(sizeof(FrameBlock), UniformBinding::Frame);
+        CameraBlock camera = { projMat * viewMat, viewMat, projMat, glm::vec4(0.0f) };
+        cameraBuffer.Set(camera); // The camera never moves, so once is enough
+
+        auto startTime = std::chrono::steady_clock::now();
+        float lastTime = 0.0f;
 
         float r = 0.0f;
         float increment = 0.01f;
-        // Loop until the user closes the window
-        while (!glfwWindowShouldClose(window))
+        int frame = 0;
+        // Loop until the user closes the window, or for a fixed number of frames when headless
+        while (headless ? frame < headlessFrames : !glfwWindowShouldClose(window))
         {
+            PROFILE_FRAME();
+            profiler.BeginFrame();
+            drawData.BeginFrame();
+
+            float time = std::chrono::duration<float>(std::chrono::steady_clock::now() - startTime).count();
+            FrameBlock frameData = { time, time - lastTime, glm::vec2(960.0f, 540.0f) };
+            frameBuffer.Set(frameData); // Once per frame, not once per program
+            lastTime = time;
+
             // Render here
             renderer.Clear();
 
-            shader.Bind();
-            // shader.SetUniform4f("u_Color", r, 0.3f, 0.8f, 1.0f);
+            {
+                PROFILE_SCOPE("Sprite");
+                auto scope = renderer.Scope("Sprite");
+                shader.Bind();
+                // shader.SetUniform4f("u_Color", r, 0.3f, 0.8f, 1.0f);
 
-            renderer.Draw(vao, ibo, shader);
+                DrawBlock sprite = { modelMat, glm::vec4(1.0f), glm::ivec4(0) };
+                renderer.Draw(vao, ibo, shader, sprite);
+            }
+
+            drawData.EndFrame();
+            profiler.EndFrame();
+            if (frame % 600 == 599) // Every ~10 seconds at 60Hz
+                profiler.PrintLastFrame();
 
             // Logic for color incrementation
             r += increment;
@@ -120,14 +323,49 @@ int main(void)
                 increment = 0.01f;
             }
 
+            GLCheckpoint("Frame");
+
+            frame++;
+            if (headless)
+                continue;
+
             // Swap front and back buffers
-            GLCall(glfwSwapBuffers(window));
+            glfwSwapBuffers(window);
 
             // Poll for and process events
-            GLCall(glfwPollEvents());
+            glfwPollEvents();
+        }
+
+        if (headless)
+        {
+            FrameCapture capture(offscreen->GetWidth(), offscreen->GetHeight());
+            std::vector<unsigned char> pixels;
+            capture.ReadNow(*offscreen, pixels);
+
+            bool raw = capturePath.size() >= 4 && capturePath.compare(capturePath.size() - 4, 4, ".raw") == 0;
+            bool written = raw ? ImageWriter::WriteRaw(capturePath, capture.GetWidth(), capture.GetHeight(), pixels.data())
+                               : ImageWriter::WritePNG(capturePath, capture.GetWidth(), capture.GetHeight(), pixels.data());
+            if (written)
+                std::cout << "Wrote frame " << frame << " to '" << capturePath << "'" << std::endl;
+
+            if (!comparePath.empty())
+            {
+                ImageDifference difference = ImageCompare::Compare(comparePath, capture.GetWidth(), capture.GetHeight(), pixels.data(), compareTolerance);
+                compareFailed = !ImageCompare::Passes(difference, 0.001f); // Up to 0.1% of the pixels may differ, edges move between drivers
+                std::cout << (compareFailed ? "FAILED" : "Passed") << " comparison with '" << comparePath << "': " << difference.DifferentPixels
+                          << " of " << difference.PixelCount << " pixels differ, largest channel difference " << difference.MaxChannelDifference << std::endl;
+            }
+
+            profiler.PrintLastFrame(); // FramesInFlight frames behind
         }
     }
 
-    glfwTerminate();
-    return 0;
+    ShaderCache::PrintStats();
+
+    if (!tracePath.empty() && CPUProfiler::WriteChromeTrace(tracePath))
+        std::cout << "Wrote CPU trace to '" << tracePath << "'" << std::endl;
+
+    if (!headless)
+        glfwTerminate();
+    return compareFailed ? 1 : 0;
 }
\ No newline at end of file
@@ -0,0 +1,174 @@
+#include "BatchRenderer.h"
+
+#include "CPUProfiler.h"
+
+#include <iostream>
+
+static std::vector<unsigned int> GenerateQuadIndices(unsigned int maxQuads)
+{
+    std::vector<unsigned int> indices(maxQuads * 6);
+    for (unsigned int i = 0, offset = 0; i < indices.size(); i += 6, offset += 4)
+    {
+        indices[i + 0] = offset + 0;
+        indices[i + 1] = offset + 1;
+        indices[i + 2] = offset + 2;
+
+        indices[i + 3] = offset + 2;
+        indices[i + 4] = offset + 3;
+        indices[i + 5] = offset + 0;
+    }
+    return indices;
+}
+
+static const unsigned int s_White = 0xffffffff;
+
+BatchRenderer::BatchRenderer(const std::string& shaderPath, unsigned int maxQuads)
+    : m_MaxQuads(maxQuads),
+      m_VertexBuffer(maxQuads * 4 * sizeof(BatchVertex)),
+      m_IndexBuffer(GenerateQuadIndices(maxQuads).data(), maxQuads * 6),
+      m_Shader(shaderPath),
+      m_WhiteTexture(1, 1, &s_White),
+      m_QuadCount(0), m_TextureSlots(), m_TextureSlotCount(1), m_TextureArray(nullptr)
+{
+    m_Vertices.resize(maxQuads * 4);
+
+    VertexBufferLayout layout;
+    layout.Push<float>(3); // Position
+    layout.Push<float>(4); // Color
+    layout.Push<float>(2); // TexCoord
+    layout.Push<float>(1); // TexIndex
+    layout.Push<float>(1); // TexLayer
+    m_VertexArray.AddBuffer(m_VertexBuffer, layout);
+
+    int samplers[MaxTextureSlots];
+    for (int i = 0; i < (int)MaxTextureSlots; i++)
+        samplers[i] = i;
+
+    m_Shader.Bind();
+    m_Shader.SetUniformArray(m_Shader.GetUniform("u_Textures"), MaxTextureSlots, samplers); // Sampler i always reads texture unit i
+    m_Shader.SetUniform(m_Shader.GetUniform("u_TextureArray"), (int)ArraySlot);
+    m_Shader.Unbind();
+    m_VertexArray.Unbind();
+
+    m_TextureSlots[0] = &m_WhiteTexture;
+}
+
+void BatchRenderer::Begin()
+{
+    m_Stats = BatchStats();
+    m_QuadCount = 0;
+    m_TextureSlotCount = 1;
+    m_TextureArray = nullptr;
+}
+
+void BatchRenderer::Submit(const glm::vec2& position, const glm::vec2& size, const glm::vec4& color)
+{
+    if (m_QuadCount == m_MaxQuads)
+        Flush();
+
+    PushQuad(position, size, color, 0.0f);
+}
+
+void BatchRenderer::Submit(const glm::vec2& position, const glm::vec2& size, const Texture& texture, const glm::vec4& tint)
+{
+    if (m_QuadCount == m_MaxQuads)
+        Flush();
+
+    PushQuad(position, size, tint, GetTextureSlot(texture));
+}
+
+void BatchRenderer::Submit(const glm::vec2& position, const glm::vec2& size, const AtlasRegion& region, const glm::vec4& tint)
+{
+    if (m_QuadCount == m_MaxQuads)
+        Flush();
+
+    if (!region.IsValid())
+    {
+        // The atlas has no such image, a plain quad in the tint colour shows where it should be
+        static bool warned = false;
+        if (!warned)
+        {
+            std::cout << "BatchRenderer got an AtlasRegion with no page, drawing it untextured" << std::endl;
+            warned = true;
+        }
+        PushQuad(position, size, tint, 0.0f);
+        return;
+    }
+
+    PushQuad(position, size, tint, GetTextureSlot(*region.Page), region.UVMin, region.UVMax);
+}
+
+void BatchRenderer::Submit(const glm::vec2& position, const glm::vec2& size, const TextureArray& array, unsigned int layer, const glm::vec4& tint)
+{
+    if (m_QuadCount == m_MaxQuads || (m_TextureArray && m_TextureArray != &array))
+        Flush();
+
+    m_TextureArray = &array;
+    PushQuad(position, size, tint, (float)ArraySlot, glm::vec2(0.0f), glm::vec2(1.0f), (float)layer);
+}
+
+void BatchRenderer::End()
+{
+    Flush();
+}
+
+void BatchRenderer::Flush()
+{
+    if (m_QuadCount == 0)
+        return;
+
+    PROFILE_FUNCTION();
+
+    unsigned int size = m_QuadCount * 4 * sizeof(BatchVertex);
+    m_VertexBuffer.SetData(m_Vertices.data(), size); // Only the used part of the buffer is uploaded
+
+    for (unsigned int i = 0; i < m_TextureSlotCount; i++)
+        m_TextureSlots[i]->Bind(i);
+    if (m_TextureArray)
+        m_TextureArray->Bind(ArraySlot);
+
+    m_Shader.Bind();
+    m_Renderer.Draw(m_VertexArray, m_IndexBuffer, m_Shader, m_QuadCount * 6);
+
+    m_Stats.FlushCount++;
+    m_Stats.BytesUploaded += size;
+
+    m_QuadCount = 0;
+    m_TextureSlotCount = 1;
+    m_TextureArray = nullptr;
+}
+
+void BatchRenderer::PushQuad(const glm::vec2& position, const glm::vec2& size, const glm::vec4& color, float texIndex, const glm::vec2& uvMin, const glm::vec2& uvMax, float texLayer)
+{
+    const glm::vec2 half = size * 0.5f;
+    const glm::vec2 corners[4] = { { -half.x, -half.y }, { half.x, -half.y }, { half.x, half.y }, { -half.x, half.y } };
+    const glm::vec2 texCoords[4] = { uvMin, { uvMax.x, uvMin.y }, uvMax, { uvMin.x, uvMax.y } }; // Same winding as the quad in Application.cpp
+
+    BatchVertex* vertex = &m_Vertices[m_QuadCount * 4];
+    for (int i = 0; i < 4; i++)
+    {
+        vertex[i].Position = glm::vec3(position + corners[i], 0.0f);
+        vertex[i].Color = color;
+        vertex[i].TexCoord = texCoords[i];
+        vertex[i].TexIndex = texIndex;
+        vertex[i].TexLayer = texLayer;
+    }
+
+    m_QuadCount++;
+    m_Stats.QuadCount++;
+}
+
+float BatchRenderer::GetTextureSlot(const Texture& texture)
+{
+    for (unsigned int i = 1; i < m_TextureSlotCount; i++)
+    {
+        if (m_TextureSlots[i] == &texture)
+            return (float)i;
+    }
+
+    if (m_TextureSlotCount == MaxTextureSlots) // Out of texture units, draw what we have and start a new batch
+        Flush();
+
+    m_TextureSlots[m_TextureSlotCount] = &texture;
+    return (float)m_TextureSlotCount++;
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include "GLPrerequisites.h"
+
+#include <array>
+#include <string>
+#include <vector>
+
+#include "Renderer.h"
+#include "VertexArray.h"
+#include "VertexBuffer.h"
+#include "IndexBuffer.h"
+#include "Shader.h"
+#include "Texture.h"
+#include "TextureArray.h"
+#include "TextureAtlas.h"
+
+#include "glm.hpp"
+
+struct BatchVertex
+{
+	glm::vec3 Position;
+	glm::vec4 Color;
+	glm::vec2 TexCoord;
+	float TexIndex;
+	float TexLayer; // Only read when TexIndex is ArraySlot
+};
+
+struct BatchStats
+{
+	unsigned int QuadCount = 0;
+	unsigned int FlushCount = 0; // One flush is one draw call
+	unsigned int BytesUploaded = 0;
+};
+
+class BatchRenderer
+{
+public:
+	static const unsigned int MaxTextureSlots = 15; // Must match the switch in Batch.shader
+	static const unsigned int ArraySlot = 15; // The last of the 16 units GL 3.3 guarantees holds one TextureArray
+private:
+	unsigned int m_MaxQuads;
+	Renderer m_Renderer;
+	VertexArray m_VertexArray;
+	VertexBuffer m_VertexBuffer; // Dynamic, re-filled on every flush
+	IndexBuffer m_IndexBuffer; // Static, the quad index pattern never changes so it is built once
+	Shader m_Shader;
+	Texture m_WhiteTexture; // Slot 0, used by untextured quads
+
+	std::vector<BatchVertex> m_Vertices; // CPU side staging for the current batch
+	unsigned int m_QuadCount;
+	std::array<const Texture*, MaxTextureSlots> m_TextureSlots;
+	unsigned int m_TextureSlotCount;
+	const TextureArray* m_TextureArray; // In ArraySlot for this batch, nullptr until a layer is submitted
+
+	BatchStats m_Stats;
+public:
+	BatchRenderer(const std::string& shaderPath, unsigned int maxQuads = 10000);
+
+	void Begin(); // Also resets the per-frame stats. The camera comes from the shared Camera uniform block
+	void Submit(const glm::vec2& position, const glm::vec2& size, const glm::vec4& color); // 'position' is the centre of the quad
+	void Submit(const glm::vec2& position, const glm::vec2& size, const Texture& texture, const glm::vec4& tint = glm::vec4(1.0f));
+	void Submit(const glm::vec2& position, const glm::vec2& size, const AtlasRegion& region, const glm::vec4& tint = glm::vec4(1.0f)); // Regions on one page share a texture slot, invalid ones draw untextured
+	void Submit(const glm::vec2& position, const glm::vec2& size, const TextureArray& array, unsigned int layer, const glm::vec4& tint = glm::vec4(1.0f)); // Any layer, a different array flushes
+	void End();
+	void Flush(); // Draws everything submitted so far in one call
+
+	inline const BatchStats& GetStats() const { return m_Stats; }
+private:
+	void PushQuad(const glm::vec2& position, const glm::vec2& size, const glm::vec4& color, float texIndex, const glm::vec2& uvMin = glm::vec2(0.0f), const glm::vec2& uvMax = glm::vec2(1.0f), float texLayer = 0.0f);
+	float GetTextureSlot(const Texture& texture);
+};
@@ -0,0 +1,108 @@
+#include "CPUProfiler.h"
+
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+
+struct ThreadBuffer
+{
+    CPUProfileEvent Events[CPUProfiler::EventsPerThread];
+    std::atomic<uint64_t> Head; // Total events ever written, the owning thread is the only writer
+    unsigned int ThreadIndex;
+    ThreadBuffer* Next;
+};
+
+static std::atomic<ThreadBuffer*> s_Buffers(nullptr); // Lock-free list, threads push themselves on their first zone
+static std::atomic<unsigned int> s_ThreadCount(0);
+static thread_local ThreadBuffer* t_Buffer = nullptr;
+
+// Reference points for turning ticks into microseconds on export
+static const uint64_t s_StartTicks = CPUProfiler::Now();
+static const std::chrono::steady_clock::time_point s_StartTime = std::chrono::steady_clock::now();
+
+static uint64_t s_LastFrame = 0; // Only the main loop marks frames
+
+static ThreadBuffer* RegisterThread()
+{
+    ThreadBuffer* buffer = new ThreadBuffer(); // Never freed, the events have to outlive the thread for the export
+    buffer->Head.store(0, std::memory_order_relaxed);
+    buffer->ThreadIndex = s_ThreadCount.fetch_add(1, std::memory_order_relaxed);
+    buffer->Next = s_Buffers.load(std::memory_order_relaxed);
+    while (!s_Buffers.compare_exchange_weak(buffer->Next, buffer, std::memory_order_release, std::memory_order_relaxed));
+    return buffer;
+}
+
+void CPUProfiler::Record(const char* name, uint64_t begin, uint64_t end)
+{
+    ThreadBuffer* buffer = t_Buffer;
+    if (!buffer)
+        buffer = t_Buffer = RegisterThread();
+
+    uint64_t head = buffer->Head.load(std::memory_order_relaxed);
+    CPUProfileEvent& event = buffer->Events[head & (EventsPerThread - 1)];
+    event.Name = name;
+    event.Begin = begin;
+    event.End = end;
+    buffer->Head.store(head + 1, std::memory_order_release); // Publishes the event to the exporter
+}
+
+void CPUProfiler::MarkFrame()
+{
+    uint64_t now = Now();
+    if (s_LastFrame != 0)
+        Record("Frame", s_LastFrame, now);
+    s_LastFrame = now;
+}
+
+static void WriteEscaped(std::ofstream& stream, const char* text)
+{
+    for (; *text; text++)
+    {
+        if (*text == '"' || *text == '\\')
+            stream << '\\';
+        stream << *text;
+    }
+}
+
+bool CPUProfiler::WriteChromeTrace(const std::string& path)
+{
+    std::ofstream stream(path);
+    if (!stream)
+    {
+        std::cout << "Failed to open '" << path << "' for writing!" << std::endl;
+        return false;
+    }
+
+    double elapsedMicroseconds = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - s_StartTime).count();
+    double ticksPerMicrosecond = elapsedMicroseconds > 0.0 ? (Now() - s_StartTicks) / elapsedMicroseconds : 1.0;
+
+    stream << std::fixed << std::setprecision(3);
+    stream << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+
+    bool first = true;
+    for (ThreadBuffer* buffer = s_Buffers.load(std::memory_order_acquire); buffer; buffer = buffer->Next)
+    {
+        uint64_t head = buffer->Head.load(std::memory_order_acquire);
+        uint64_t count = head < EventsPerThread ? head : EventsPerThread;
+
+        stream << (first ? "" : ",") << "\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":" << buffer->ThreadIndex
+            << ",\"args\":{\"name\":\"Thread " << buffer->ThreadIndex << "\"}}";
+        first = false;
+
+        for (uint64_t i = head - count; i < head; i++)
+        {
+            const CPUProfileEvent& event = buffer->Events[i & (EventsPerThread - 1)];
+            double begin = event.Begin > s_StartTicks ? (event.Begin - s_StartTicks) / ticksPerMicrosecond : 0.0;
+            double duration = event.End > event.Begin ? (event.End - event.Begin) / ticksPerMicrosecond : 0.0;
+
+            stream << ",\n{\"name\":\"";
+            WriteEscaped(stream, event.Name);
+            stream << "\",\"ph\":\"X\",\"pid\":0,\"tid\":" << buffer->ThreadIndex << ",\"ts\":" << begin << ",\"dur\":" << duration << "}";
+        }
+    }
+
+    stream << "\n]}\n";
+    return stream.good();
+}
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#define CPU_PROFILER_TSC 1
+#elif (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#include <x86intrin.h>
+#define CPU_PROFILER_TSC 1
+#else
+#include <chrono>
+#define CPU_PROFILER_TSC 0
+#endif
+
+/*
+Scoped CPU zones written into per-thread ring buffers. Each thread only ever writes its own buffer and
+publishes it with one atomic store, so recording takes no locks. Timestamps are raw TSC ticks where the
+CPU has them, converted to microseconds only on export.
+
+    PROFILE_SCOPE("Name");  times the rest of the enclosing block
+    PROFILE_FUNCTION();     same, named after the function
+    PROFILE_FRAME();        call once per frame, the time between calls shows up as a "Frame" zone
+
+Everything compiles away when CPU_PROFILING is 0. Zone names must be string literals (or otherwise live
+forever), only the pointer is stored.
+*/
+#ifndef CPU_PROFILING
+#define CPU_PROFILING 1
+#endif
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+
+#if CPU_PROFILING
+#define PROFILE_SCOPE(name) CPUProfileZone PROFILE_CONCAT(profileZone, __LINE__)(name)
+#define PROFILE_FUNCTION() PROFILE_SCOPE(__FUNCTION__)
+#define PROFILE_FRAME() CPUProfiler::MarkFrame()
+#else
+#define PROFILE_SCOPE(name)
+#define PROFILE_FUNCTION()
+#define PROFILE_FRAME()
+#endif
+
+struct CPUProfileEvent
+{
+	const char* Name;
+	uint64_t Begin; // Ticks
+	uint64_t End;
+};
+
+class CPUProfiler
+{
+public:
+	static const unsigned int EventsPerThread = 1 << 16; // Ring size, oldest events are overwritten
+private:
+	CPUProfiler() {} // Static only
+public:
+	inline static uint64_t Now() // Ticks, TSC or steady_clock nanoseconds
+	{
+#if CPU_PROFILER_TSC
+		return __rdtsc();
+#else
+		return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+	}
+	static void Record(const char* name, uint64_t begin, uint64_t end);
+	static void MarkFrame();
+
+	// Best called while the other threads are idle, events written during the export may come out torn
+	static bool WriteChromeTrace(const std::string& path);
+};
+
+class CPUProfileZone
+{
+private:
+	const char* m_Name;
+	uint64_t m_Begin;
+public:
+	inline CPUProfileZone(const char* name)
+		: m_Name(name), m_Begin(CPUProfiler::Now()) {}
+	inline ~CPUProfileZone() { CPUProfiler::Record(m_Name, m_Begin, CPUProfiler::Now()); }
+
+	CPUProfileZone(const CPUProfileZone&) = delete;
+	CPUProfileZone& operator=(const CPUProfileZone&) = delete;
+};
@@ -0,0 +1,162 @@
+#include "ComputeCheck.h"
+
+#include "ComputeShader.h"
+#include "GLState.h"
+#include "ShaderStorageBuffer.h"
+#include "Texture.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "glm.hpp"
+
+struct Particle // "Particle" in include/Particles.glsl, std430
+{
+    glm::vec4 Position;
+    glm::vec4 Velocity;
+};
+
+struct ParticleCounters // "Counters" in include/Particles.glsl
+{
+    DispatchIndirectCommand Command;
+    unsigned int AliveCount;
+    unsigned int Launched;
+};
+
+static bool Report(const char* name, bool passed, const std::string& detail = "")
+{
+    std::cout << "[Compute] " << name << (passed ? " passed" : " FAILED") << (detail.empty() ? "" : ", ") << detail << std::endl;
+    return passed;
+}
+
+static bool CheckParticles()
+{
+    const int count = 1000; // Not a multiple of 64, so the last group of each pass is partly used
+    const float deltaTime = 0.1f, gravity = 9.81f;
+
+    std::vector<Particle> expected(count);
+    for (int i = 0; i < count; i++)
+    {
+        Particle& particle = expected[i];
+        particle.Position = glm::vec4((float)i, 1.0f + (i % 10) * 0.25f, 0.0f, i % 7 == 0 ? 0.0f : 1.0f); // Every 7th starts dead
+        particle.Velocity = glm::vec4(1.0f, i % 3 == 0 ? -50.0f : 2.0f, 0.5f, 0.0f); // Every 3rd falls through the floor
+    }
+
+    ComputeShader update("res/shaders/ParticleUpdate.shader");
+    ComputeShader applyGravity("res/shaders/ParticleGravity.shader");
+    if (!update.IsValid() || !applyGravity.IsValid())
+        return Report("Particles", false, "the shaders did not load");
+
+    ShaderStorageBuffer particles(count * sizeof(Particle), expected.data());
+    ParticleCounters counters = { { 0, 1, 1 }, 0, 0 };
+    ShaderStorageBuffer counterBuffer(sizeof(ParticleCounters), &counters);
+    ShaderStorageBuffer aliveList(count * sizeof(unsigned int));
+    particles.BindBase(0);
+    counterBuffer.BindBase(1);
+    aliveList.BindBase(2);
+
+    update.Bind();
+    update.SetUniform(update.GetUniform("u_Count"), count);
+    update.SetUniform(update.GetUniform("u_DeltaTime"), deltaTime);
+    update.DispatchThreads(count);
+    ComputeShader::Barrier(GL_SHADER_STORAGE_BARRIER_BIT | GL_COMMAND_BARRIER_BIT); // ParticleGravity reads the list, the dispatch reads the command
+
+    applyGravity.Bind();
+    applyGravity.SetUniform(applyGravity.GetUniform("u_Gravity"), gravity);
+    applyGravity.SetUniform(applyGravity.GetUniform("u_DeltaTime"), deltaTime);
+    applyGravity.DispatchIndirect(counterBuffer);
+    ComputeShader::Barrier(GL_BUFFER_UPDATE_BARRIER_BIT);
+
+    std::vector<Particle> result(count);
+    std::vector<unsigned int> alive(count);
+    particles.GetData(result.data(), count * sizeof(Particle));
+    counterBuffer.GetData(&counters, sizeof(ParticleCounters));
+    aliveList.GetData(alive.data(), count * sizeof(unsigned int));
+
+    std::vector<unsigned int> expectedAlive;
+    for (int i = 0; i < count; i++)
+    {
+        Particle& particle = expected[i];
+        if (particle.Position.w == 0.0f)
+            continue;
+        particle.Position += glm::vec4(glm::vec3(particle.Velocity) * deltaTime, 0.0f);
+        if (particle.Position.y < 0.0f)
+        {
+            particle.Position.w = 0.0f;
+            continue;
+        }
+        particle.Velocity.y -= gravity * deltaTime;
+        expectedAlive.push_back(i);
+    }
+
+    unsigned int groups = ((unsigned int)expectedAlive.size() + 63) / 64;
+    bool passed = Report("Dispatch", counters.AliveCount == expectedAlive.size(),
+        std::to_string(counters.AliveCount) + " of " + std::to_string(count) + " particles alive, " + std::to_string(expectedAlive.size()) + " expected");
+    passed &= Report("DispatchIndirect", counters.Command.GroupsX == groups && counters.Launched == groups * 64,
+        std::to_string(counters.Command.GroupsX) + " groups and " + std::to_string(counters.Launched) + " threads, " + std::to_string(groups) + " groups expected");
+
+    alive.resize(std::min<size_t>(counters.AliveCount, alive.size()));
+    std::sort(alive.begin(), alive.end());
+    passed &= Report("Alive list", alive == expectedAlive);
+
+    float maxError = 0.0f;
+    for (int i = 0; i < count; i++)
+    {
+        for (int c = 0; c < 4; c++)
+        {
+            maxError = std::max(maxError, std::abs(result[i].Position[c] - expected[i].Position[c]));
+            maxError = std::max(maxError, std::abs(result[i].Velocity[c] - expected[i].Velocity[c]));
+        }
+    }
+    passed &= Report("SSBO readback", maxError < 1e-4f, "largest difference " + std::to_string(maxError));
+    return passed;
+}
+
+static bool CheckInvert()
+{
+    const int width = 37, height = 23; // Not multiples of the 8x8 groups, the edge threads have to bail out
+    std::vector<unsigned char> pixels((size_t)width * height * 4);
+    for (size_t i = 0; i < pixels.size(); i++)
+        pixels[i] = (unsigned char)(i * 7 + i / 4);
+
+    ComputeShader invert("res/shaders/Invert.shader");
+    if (!invert.IsValid())
+        return Report("Image invert", false, "the shader did not load");
+
+    Texture source(width, height, pixels.data());
+    Texture destination(width, height, nullptr);
+    source.BindImage(0, GL_READ_ONLY);
+    destination.BindImage(1, GL_WRITE_ONLY);
+    invert.DispatchThreads(width, height);
+    ComputeShader::Barrier(GL_TEXTURE_UPDATE_BARRIER_BIT);
+
+    std::vector<unsigned char> result(pixels.size());
+    GLState::BindTexture(GL_TEXTURE_2D, destination.GetRendererID());
+    GLCall(glGetTexImage(GL_TEXTURE_2D, 0, GL_RGBA, GL_UNSIGNED_BYTE, result.data()));
+    GLState::BindTexture(GL_TEXTURE_2D, 0);
+
+    unsigned int wrong = 0;
+    for (size_t i = 0; i < pixels.size(); i++)
+    {
+        unsigned char expected = i % 4 == 3 ? pixels[i] : (unsigned char)(255 - pixels[i]); // Alpha is kept
+        if (result[i] != expected)
+            wrong++;
+    }
+    return Report("Image invert", wrong == 0, std::to_string(wrong) + " wrong channels");
+}
+
+bool RunComputeCheck()
+{
+    if (!ComputeShader::IsSupported())
+    {
+        std::cout << "[Compute] Not supported by this context (needs GL 4.3 or ARB_compute_shader)" << std::endl;
+        return false;
+    }
+
+    bool passed = CheckParticles();
+    passed &= CheckInvert();
+    return passed;
+}
@@ -0,0 +1,6 @@
+#pragma once
+
+// Runs the compute samples (ParticleUpdate, ParticleGravity and Invert in res/shaders) once on small
+// inputs and checks every result against the same work done on the CPU. Covers Dispatch, DispatchThreads,
+// DispatchIndirect, Barrier and ShaderStorageBuffer readback, on the current context
+bool RunComputeCheck();
@@ -0,0 +1,52 @@
+#include "ComputeShader.h"
+
+#include "ShaderStorageBuffer.h"
+
+ComputeShader::ComputeShader(const std::string& filepath)
+    : Shader(filepath), m_WorkGroupSize{ 1, 1, 1 }
+{
+    if (!IsValid())
+        return;
+
+    int size[3];
+    GLCall(glGetProgramiv(GetRendererID(), GL_COMPUTE_WORK_GROUP_SIZE, size)); // Errors if there is no compute stage
+    for (int i = 0; i < 3; i++)
+        m_WorkGroupSize[i] = (unsigned int)size[i];
+}
+
+void ComputeShader::Dispatch(unsigned int groupsX, unsigned int groupsY, unsigned int groupsZ) const
+{
+    if (!IsValid() || groupsX == 0 || groupsY == 0 || groupsZ == 0)
+        return;
+
+    Bind();
+    GLCall(glDispatchCompute(groupsX, groupsY, groupsZ));
+}
+
+void ComputeShader::DispatchThreads(unsigned int threadsX, unsigned int threadsY, unsigned int threadsZ) const
+{
+    Dispatch((threadsX + m_WorkGroupSize[0] - 1) / m_WorkGroupSize[0],
+             (threadsY + m_WorkGroupSize[1] - 1) / m_WorkGroupSize[1],
+             (threadsZ + m_WorkGroupSize[2] - 1) / m_WorkGroupSize[2]);
+}
+
+void ComputeShader::DispatchIndirect(const ShaderStorageBuffer& commands, unsigned int offset) const
+{
+    if (!IsValid())
+        return;
+
+    ASSERT(offset % 4 == 0 && offset + sizeof(DispatchIndirectCommand) <= commands.GetSize());
+    Bind();
+    commands.BindAs(GL_DISPATCH_INDIRECT_BUFFER);
+    GLCall(glDispatchComputeIndirect(offset));
+}
+
+bool ComputeShader::IsSupported()
+{
+    return Shader::IsStageSupported(ShaderStage::Compute) && (GLEW_VERSION_4_3 || GLEW_ARB_shader_storage_buffer_object);
+}
+
+void ComputeShader::Barrier(unsigned int barriers)
+{
+    GLCall(glMemoryBarrier(barriers));
+}
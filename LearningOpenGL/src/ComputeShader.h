@@ -0,0 +1,44 @@
+#pragma once
+
+#include "GLPrerequisites.h"
+
+#include <string>
+
+#include "Shader.h"
+
+class ShaderStorageBuffer;
+
+struct DispatchIndirectCommand // What DispatchIndirect reads, usually written by an earlier compute pass
+{
+	unsigned int GroupsX, GroupsY, GroupsZ;
+};
+
+/*
+Program made from a .shader file with only a "#shader compute" section. Dispatch takes work groups,
+DispatchThreads takes a thread count and rounds it up to whole groups (the shader has to skip the
+threads past the end). Neither waits for the GPU, call Barrier with how the results are read next
+before reading them:
+
+    particles.Dispatch...;
+    ComputeShader::Barrier(GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT); // The particle buffer is drawn from next
+
+Needs GL 4.3 or ARB_compute_shader, see IsSupported. On older contexts the shader fails to load and
+dispatching does nothing.
+*/
+class ComputeShader : public Shader
+{
+private:
+	unsigned int m_WorkGroupSize[3]; // layout(local_size_x = ...) in
+public:
+	ComputeShader(const std::string& filepath);
+
+	void Dispatch(unsigned int groupsX, unsigned int groupsY = 1, unsigned int groupsZ = 1) const;
+	void DispatchThreads(unsigned int threadsX, unsigned int threadsY = 1, unsigned int threadsZ = 1) const;
+	void DispatchIndirect(const ShaderStorageBuffer& commands, unsigned int offset = 0) const; // A DispatchIndirectCommand at 'offset'
+
+	inline bool IsValid() const { return GetRendererID() != 0; }
+	inline const unsigned int* GetWorkGroupSize() const { return m_WorkGroupSize; }
+
+	static bool IsSupported();
+	static void Barrier(unsigned int barriers); // glMemoryBarrier, GL_SHADER_STORAGE_BARRIER_BIT etc. for how the data is used next
+};
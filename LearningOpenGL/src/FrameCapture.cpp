@@ -0,0 +1,69 @@
+#include "FrameCapture.h"
+
+#include <cstring>
+
+#include "GLState.h"
+
+FrameCapture::FrameCapture(int width, int height)
+	: m_Pending{ false, false }, m_Index(0), m_Width(width), m_Height(height)
+{
+	GLCall(glGenBuffers(2, m_PixelBuffers));
+	for (int i = 0; i < 2; i++)
+	{
+		GLState::BindBuffer(GL_PIXEL_PACK_BUFFER, m_PixelBuffers[i]);
+		GLCall(glBufferData(GL_PIXEL_PACK_BUFFER, m_Width * m_Height * 4, nullptr, GL_STREAM_READ));
+	}
+	GLState::BindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+}
+
+FrameCapture::~FrameCapture()
+{
+	GLCall(glDeleteBuffers(2, m_PixelBuffers));
+	GLState::OnBufferDeleted(m_PixelBuffers[0]);
+	GLState::OnBufferDeleted(m_PixelBuffers[1]);
+}
+
+void FrameCapture::Capture(const Framebuffer& framebuffer)
+{
+	framebuffer.Bind();
+	GLState::BindBuffer(GL_PIXEL_PACK_BUFFER, m_PixelBuffers[m_Index]);
+	GLCall(glPixelStorei(GL_PACK_ALIGNMENT, 1));
+	GLCall(glReadPixels(0, 0, m_Width, m_Height, GL_RGBA, GL_UNSIGNED_BYTE, nullptr)); // With a PBO bound this only queues the copy
+	GLState::BindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+	m_Pending[m_Index] = true;
+	m_Index ^= 1;
+}
+
+bool FrameCapture::GetPrevious(std::vector<unsigned char>& pixels)
+{
+	unsigned int previous = m_Index; // After Capture flips, m_Index points at the older of the two
+	if (!m_Pending[previous])
+		return false;
+
+	Map(previous, pixels);
+	return true;
+}
+
+void FrameCapture::ReadNow(const Framebuffer& framebuffer, std::vector<unsigned char>& pixels)
+{
+	Capture(framebuffer);
+	Map(m_Index ^ 1, pixels);
+}
+
+void FrameCapture::Map(unsigned int index, std::vector<unsigned char>& pixels)
+{
+	const unsigned int size = m_Width * m_Height * 4;
+	pixels.resize(size);
+
+	GLState::BindBuffer(GL_PIXEL_PACK_BUFFER, m_PixelBuffers[index]);
+	GLCall(const void* data = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, size, GL_MAP_READ_BIT));
+	if (data)
+	{
+		std::memcpy(pixels.data(), data, size);
+		GLCall(glUnmapBuffer(GL_PIXEL_PACK_BUFFER));
+	}
+	GLState::BindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+	m_Pending[index] = false;
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include "GLPrerequisites.h"
+
+#include <vector>
+
+#include "Framebuffer.h"
+
+class FrameCapture // Reads frames back through two pixel pack buffers so the CPU never waits on the frame it just drew
+{
+private:
+	unsigned int m_PixelBuffers[2];
+	bool m_Pending[2];
+	unsigned int m_Index; // Buffer the next Capture writes to
+	int m_Width, m_Height;
+public:
+	FrameCapture(int width, int height);
+	~FrameCapture();
+
+	void Capture(const Framebuffer& framebuffer); // Queues the copy and returns straight away
+	bool GetPrevious(std::vector<unsigned char>& pixels); // Pixels from the capture before the latest one, false if there is none
+	void ReadNow(const Framebuffer& framebuffer, std::vector<unsigned char>& pixels); // Blocking, for the last frame of a run
+
+	inline int GetWidth() const { return m_Width; }
+	inline int GetHeight() const { return m_Height; }
+private:
+	void Map(unsigned int index, std::vector<unsigned char>& pixels);
+};
\ No newline at end of file
@@ -0,0 +1,22 @@
+#pragma once
+
+#include "GLPrerequisites.h"
+
+class Framebuffer // Offscreen render target, RGBA8 colour texture plus a depth/stencil renderbuffer
+{
+private:
+	unsigned int m_RendererID;
+	unsigned int m_ColorAttachment;
+	unsigned int m_DepthAttachment;
+	int m_Width, m_Height;
+public:
+	Framebuffer(int width, int height);
+	~Framebuffer();
+
+	void Bind() const; // Also sets the viewport to the framebuffer size
+	void Unbind() const;
+
+	inline unsigned int GetColorAttachment() const { return m_ColorAttachment; }
+	inline int GetWidth() const { return m_Width; }
+	inline int GetHeight() const { return m_Height; }
+};
\ No newline at end of file
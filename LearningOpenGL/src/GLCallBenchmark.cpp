@@ -0,0 +1,85 @@
+#include "GLCallBenchmark.h"
+
+#include "GLPrerequisites.h"
+#include "GLState.h"
+
+#include <chrono>
+#include <iostream>
+
+template<typename Body>
+static double MeasureNanosecondsPerCall(unsigned int iterations, Body body)
+{
+    GLCall(glFinish());
+    auto start = std::chrono::high_resolution_clock::now();
+    for (unsigned int i = 0; i < iterations; i++)
+        body(i);
+    GLCall(glFinish());
+    auto end = std::chrono::high_resolution_clock::now();
+    return std::chrono::duration<double, std::nano>(end - start).count() / iterations;
+}
+
+void RunGLCallBenchmark(unsigned int iterations)
+{
+    unsigned int buffers[2];
+    GLCall(glGenBuffers(2, buffers));
+
+    // Alternating binds so the driver can't drop the call as a no-op. Bypasses GLState on purpose
+    auto call = [&buffers](unsigned int i) { glBindBuffer(GL_ARRAY_BUFFER, buffers[i & 1]); };
+
+    double release = MeasureNanosecondsPerCall(iterations, [&](unsigned int i)
+    {
+        call(i);
+    });
+
+    double checked = MeasureNanosecondsPerCall(iterations, [&](unsigned int i)
+    {
+        call(i);
+        if (i % 1000 == 999) // Stand-in for one GLCheckpoint per pass
+            GLCheckErrors("Benchmark");
+    });
+
+    double perCall = MeasureNanosecondsPerCall(iterations, [&](unsigned int i)
+    {
+        GLClearError();
+        call(i);
+        GLLogCall("glBindBuffer", __FILE__, __LINE__);
+    });
+
+    double debugAsync = -1.0, debugSync = -1.0;
+    if (GLEnableDebugOutput(false))
+    {
+        debugAsync = MeasureNanosecondsPerCall(iterations, [&](unsigned int i)
+        {
+            GLBeginCall("glBindBuffer", __FILE__, __LINE__);
+            call(i);
+            GLEndCall();
+        });
+
+        GLEnableDebugOutput(true);
+        debugSync = MeasureNanosecondsPerCall(iterations, [&](unsigned int i)
+        {
+            GLBeginCall("glBindBuffer", __FILE__, __LINE__);
+            call(i);
+            GLEndCall();
+        });
+        GLDisableDebugOutput();
+    }
+
+    GLCall(glBindBuffer(GL_ARRAY_BUFFER, 0));
+    GLCall(glDeleteBuffers(2, buffers));
+    GLState::Invalidate(); // The raw binds above went around the cache
+
+    std::cout << "GLCall overhead, " << iterations << " x glBindBuffer (ns per call):" << std::endl;
+    std::cout << "    release             " << release << std::endl;
+    std::cout << "    checked             " << checked << std::endl;
+    std::cout << "    glGetError per call " << perCall << std::endl;
+    if (debugAsync >= 0.0)
+    {
+        std::cout << "    debug (async)       " << debugAsync << std::endl;
+        std::cout << "    debug (sync)        " << debugSync << std::endl;
+    }
+    else
+    {
+        std::cout << "    debug               n/a, no KHR_debug (same as glGetError per call)" << std::endl;
+    }
+}
@@ -0,0 +1,5 @@
+#pragma once
+
+// Measures what each GLCALL_MODE costs per GL call, on the current context. All of the modes are
+// spelled out by hand here so one build can compare them
+void RunGLCallBenchmark(unsigned int iterations = 1000000);
\ No newline at end of file
@@ -2,10 +2,70 @@
 
 #include <GL/glew.h>
 
-#define ASSERT(x) if (!(x)) __debugbreak();
-#define GLCall(x) GLClearError();\
+#if defined(_MSC_VER)
+#define DEBUG_BREAK() __debugbreak()
+#elif defined(__GNUC__) || defined(__clang__)
+#define DEBUG_BREAK() __builtin_trap()
+#else
+#include <cstdlib>
+#define DEBUG_BREAK() std::abort()
+#endif
+
+#define ASSERT(x) if (!(x)) DEBUG_BREAK();
+
+/*
+How GLCall checks for errors, picked at compile time with GLCALL_MODE:
+
+    RELEASE - GLCall(x) is just x, no overhead at all.
+    CHECKED - GLCall(x) is just x, GLCheckpoint("name") drains glGetError once per frame or pass and
+              reports which one it went wrong in.
+    DEBUG   - Errors come in through the KHR_debug callback (GLEnableDebugOutput), GLCall only records
+              the call site so the callback can name it. Only synchronous output (--gl-sync) names the
+              call site and breaks on the failing GLCall, asynchronous messages are just printed. Falls
+              back to glGetError after every call when the context has no KHR_debug.
+
+Defaults to DEBUG when _DEBUG is defined, RELEASE otherwise.
+*/
+#define GLCALL_MODE_RELEASE 0
+#define GLCALL_MODE_CHECKED 1
+#define GLCALL_MODE_DEBUG 2
+
+#ifndef GLCALL_MODE
+#ifdef _DEBUG
+#define GLCALL_MODE GLCALL_MODE_DEBUG
+#else
+#define GLCALL_MODE GLCALL_MODE_RELEASE
+#endif
+#endif
+
+#if GLCALL_MODE == GLCALL_MODE_DEBUG
+#define GLCall(x) GLBeginCall(#x, __FILE__, __LINE__);\
     x;\
-    ASSERT(GLLogCall(#x, __FILE__, __LINE__));
+    ASSERT(GLEndCall());
+#define GLCheckpoint(name)
+#elif GLCALL_MODE == GLCALL_MODE_CHECKED
+#define GLCall(x) x
+#define GLCheckpoint(name) ASSERT(GLCheckErrors(name));
+#else
+#define GLCall(x) x
+#define GLCheckpoint(name)
+#endif
 
 void GLClearError();
-bool GLLogCall(const char* function, const char* file, int line);
\ No newline at end of file
+bool GLLogCall(const char* function, const char* file, int line);
+
+void GLBeginCall(const char* function, const char* file, int line);
+bool GLEndCall();
+bool GLCheckErrors(const char* checkpoint);
+bool GLEnableDebugOutput(bool synchronous); // Synchronous output makes the callback run inside the failing call, slower but the stack is useful
+void GLDisableDebugOutput();
+
+struct GLContextVersion
+{
+	int Major, Minor;
+};
+
+// Asked for newest first until the driver accepts one. 4.3 brings compute shaders and storage buffers, 3.3 is the
+// floor everything else is written for, check GLEW_VERSION_* / extensions before using anything newer
+static const GLContextVersion GLContextVersions[] = { { 4, 6 }, { 4, 5 }, { 4, 3 }, { 3, 3 } };
+static const unsigned int GLContextVersionCount = sizeof(GLContextVersions) / sizeof(GLContextVersions[0]);
\ No newline at end of file
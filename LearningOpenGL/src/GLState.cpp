@@ -0,0 +1,545 @@
+#include "GLState.h"
+
+#include <iostream>
+#include <unordered_map>
+
+static const unsigned int s_Unknown = 0xFFFFFFFF; // Cache slot has never been set, or was invalidated
+
+// Targets the cache knows about, with the glGet enum used to validate them. GL_ELEMENT_ARRAY_BUFFER is handled apart
+// because that binding belongs to the bound VAO
+struct TargetInfo
+{
+    GLenum Target;
+    GLenum Binding;
+};
+
+static const TargetInfo s_BufferTargets[] =
+{
+    { GL_ARRAY_BUFFER,              GL_ARRAY_BUFFER_BINDING },
+    { GL_UNIFORM_BUFFER,            GL_UNIFORM_BUFFER_BINDING },
+    { GL_SHADER_STORAGE_BUFFER,     GL_SHADER_STORAGE_BUFFER_BINDING },
+    { GL_PIXEL_PACK_BUFFER,         GL_PIXEL_PACK_BUFFER_BINDING },
+    { GL_PIXEL_UNPACK_BUFFER,       GL_PIXEL_UNPACK_BUFFER_BINDING },
+    { GL_COPY_READ_BUFFER,          GL_COPY_READ_BUFFER_BINDING },
+    { GL_COPY_WRITE_BUFFER,         GL_COPY_WRITE_BUFFER_BINDING },
+    { GL_DRAW_INDIRECT_BUFFER,      GL_DRAW_INDIRECT_BUFFER_BINDING },
+    { GL_DISPATCH_INDIRECT_BUFFER,  GL_DISPATCH_INDIRECT_BUFFER_BINDING },
+};
+static const unsigned int s_BufferTargetCount = sizeof(s_BufferTargets) / sizeof(s_BufferTargets[0]);
+
+static const TargetInfo s_IndexedTargets[] =
+{
+    { GL_UNIFORM_BUFFER,            GL_UNIFORM_BUFFER_BINDING },
+    { GL_SHADER_STORAGE_BUFFER,     GL_SHADER_STORAGE_BUFFER_BINDING },
+};
+static const unsigned int s_IndexedTargetCount = sizeof(s_IndexedTargets) / sizeof(s_IndexedTargets[0]);
+
+struct IndexedBinding
+{
+    unsigned int Buffer;
+    GLintptr Offset;
+    GLsizeiptr Size; // 0 for a whole-buffer BindBufferBase
+};
+
+static const TargetInfo s_TextureTargets[] =
+{
+    { GL_TEXTURE_2D,        GL_TEXTURE_BINDING_2D },
+    { GL_TEXTURE_2D_ARRAY,  GL_TEXTURE_BINDING_2D_ARRAY },
+    { GL_TEXTURE_3D,        GL_TEXTURE_BINDING_3D },
+    { GL_TEXTURE_CUBE_MAP,  GL_TEXTURE_BINDING_CUBE_MAP },
+};
+static const unsigned int s_TextureTargetCount = sizeof(s_TextureTargets) / sizeof(s_TextureTargets[0]);
+
+struct StateCache
+{
+    unsigned int Program;
+    unsigned int ProgramPipeline;
+    unsigned int VertexArray;
+    unsigned int Buffers[s_BufferTargetCount];
+    IndexedBinding IndexedBuffers[s_IndexedTargetCount][GLState::MaxBufferBindings];
+    std::unordered_map<unsigned int, unsigned int> ElementBuffers; // VAO -> bound element buffer
+    unsigned int ActiveUnit;
+    unsigned int Textures[GLState::MaxTextureUnits][s_TextureTargetCount];
+    unsigned int Samplers[GLState::MaxTextureUnits];
+    unsigned int Blend;
+    unsigned int BlendSrc;
+    unsigned int BlendDst;
+    GLStateCounters Counters;
+
+    StateCache() { Reset(); }
+
+    void Reset() // Counters are kept
+    {
+        Program = s_Unknown;
+        ProgramPipeline = s_Unknown;
+        VertexArray = s_Unknown;
+        for (unsigned int i = 0; i < s_BufferTargetCount; i++)
+            Buffers[i] = s_Unknown;
+        for (unsigned int i = 0; i < s_IndexedTargetCount; i++)
+        {
+            for (unsigned int index = 0; index < GLState::MaxBufferBindings; index++)
+                IndexedBuffers[i][index] = { s_Unknown, 0, 0 };
+        }
+        ElementBuffers.clear();
+        ActiveUnit = s_Unknown;
+        for (unsigned int unit = 0; unit < GLState::MaxTextureUnits; unit++)
+        {
+            for (unsigned int i = 0; i < s_TextureTargetCount; i++)
+                Textures[unit][i] = s_Unknown;
+            Samplers[unit] = s_Unknown;
+        }
+        Blend = s_Unknown;
+        BlendSrc = s_Unknown;
+        BlendDst = s_Unknown;
+    }
+};
+
+static StateCache s_State;
+
+static int FindTarget(const TargetInfo* targets, unsigned int count, unsigned int target)
+{
+    for (unsigned int i = 0; i < count; i++)
+    {
+        if (targets[i].Target == target)
+            return (int)i;
+    }
+    return -1;
+}
+
+static unsigned int QueryIndexedBinding(GLenum binding, unsigned int index)
+{
+    int buffer = 0;
+    GLCall(glGetIntegeri_v(binding, index, &buffer));
+    return (unsigned int)buffer;
+}
+
+#ifdef GLSTATE_VALIDATE
+static bool CheckInteger(GLenum pname, unsigned int expected, const char* name)
+{
+    int value = 0;
+    GLCall(glGetIntegerv(pname, &value));
+    if ((unsigned int)value != expected)
+    {
+        std::cout << "[GLState] " << name << " is " << value << " but the cache has " << expected << std::endl;
+        return false;
+    }
+    return true;
+}
+
+static unsigned int QueryTextureBinding(unsigned int unit, GLenum binding)
+{
+    int active = 0, texture = 0;
+    GLCall(glGetIntegerv(GL_ACTIVE_TEXTURE, &active));
+    GLCall(glActiveTexture(GL_TEXTURE0 + unit));
+    GLCall(glGetIntegerv(binding, &texture));
+    GLCall(glActiveTexture(active)); // Put it back, the cache must not notice
+    return (unsigned int)texture;
+}
+
+#define GLSTATE_CHECK(pname, expected) ASSERT(CheckInteger(pname, expected, #pname))
+#else
+#define GLSTATE_CHECK(pname, expected)
+#endif
+
+static void Skip()
+{
+    s_State.Counters.Skipped++;
+}
+
+static void Issue()
+{
+    s_State.Counters.Issued++;
+}
+
+void GLState::UseProgram(unsigned int program)
+{
+    if (s_State.Program == program)
+    {
+        Skip();
+        GLSTATE_CHECK(GL_CURRENT_PROGRAM, program);
+        return;
+    }
+
+    Issue();
+    GLCall(glUseProgram(program));
+    s_State.Program = program;
+}
+
+void GLState::BindProgramPipeline(unsigned int pipeline)
+{
+    UseProgram(0);
+    if (s_State.ProgramPipeline == pipeline)
+    {
+        Skip();
+        GLSTATE_CHECK(GL_PROGRAM_PIPELINE_BINDING, pipeline);
+        return;
+    }
+
+    Issue();
+    GLCall(glBindProgramPipeline(pipeline));
+    s_State.ProgramPipeline = pipeline;
+}
+
+void GLState::BindVertexArray(unsigned int vertexArray)
+{
+    if (s_State.VertexArray == vertexArray)
+    {
+        Skip();
+        GLSTATE_CHECK(GL_VERTEX_ARRAY_BINDING, vertexArray);
+        return;
+    }
+
+    Issue();
+    GLCall(glBindVertexArray(vertexArray));
+    s_State.VertexArray = vertexArray;
+}
+
+void GLState::BindBuffer(unsigned int target, unsigned int buffer)
+{
+    if (target == GL_ELEMENT_ARRAY_BUFFER)
+    {
+        if (s_State.VertexArray != s_Unknown)
+        {
+            auto it = s_State.ElementBuffers.find(s_State.VertexArray);
+            if (it != s_State.ElementBuffers.end() && it->second == buffer)
+            {
+                Skip();
+                GLSTATE_CHECK(GL_ELEMENT_ARRAY_BUFFER_BINDING, buffer);
+                return;
+            }
+        }
+
+        Issue();
+        GLCall(glBindBuffer(target, buffer));
+        if (s_State.VertexArray != s_Unknown)
+            s_State.ElementBuffers[s_State.VertexArray] = buffer;
+        return;
+    }
+
+    int slot = FindTarget(s_BufferTargets, s_BufferTargetCount, target);
+    if (slot >= 0 && s_State.Buffers[slot] == buffer)
+    {
+        Skip();
+        GLSTATE_CHECK(s_BufferTargets[slot].Binding, buffer);
+        return;
+    }
+
+    Issue();
+    GLCall(glBindBuffer(target, buffer));
+    if (slot >= 0)
+        s_State.Buffers[slot] = buffer;
+}
+
+static void BindIndexed(unsigned int target, unsigned int index, unsigned int buffer, GLintptr offset, GLsizeiptr size)
+{
+    int slot = FindTarget(s_IndexedTargets, s_IndexedTargetCount, target);
+    bool cached = slot >= 0 && index < GLState::MaxBufferBindings;
+    if (cached)
+    {
+        const IndexedBinding& binding = s_State.IndexedBuffers[slot][index];
+        if (binding.Buffer == buffer && binding.Offset == offset && binding.Size == size)
+        {
+            Skip();
+#ifdef GLSTATE_VALIDATE
+            ASSERT(QueryIndexedBinding(s_IndexedTargets[slot].Binding, index) == buffer);
+#endif
+            return;
+        }
+    }
+
+    Issue();
+    if (size == 0)
+    {
+        GLCall(glBindBufferBase(target, index, buffer));
+    }
+    else
+    {
+        GLCall(glBindBufferRange(target, index, buffer, offset, size));
+    }
+    if (cached)
+        s_State.IndexedBuffers[slot][index] = { buffer, offset, size };
+
+    int generic = FindTarget(s_BufferTargets, s_BufferTargetCount, target); // Indexed binds also replace the generic binding
+    if (generic >= 0)
+        s_State.Buffers[generic] = buffer;
+}
+
+void GLState::BindBufferBase(unsigned int target, unsigned int index, unsigned int buffer)
+{
+    BindIndexed(target, index, buffer, 0, 0);
+}
+
+void GLState::BindBufferRange(unsigned int target, unsigned int index, unsigned int buffer, GLintptr offset, GLsizeiptr size)
+{
+    BindIndexed(target, index, buffer, offset, size);
+}
+
+void GLState::ActiveTexture(unsigned int unit)
+{
+    if (s_State.ActiveUnit == unit)
+    {
+        Skip();
+        GLSTATE_CHECK(GL_ACTIVE_TEXTURE, GL_TEXTURE0 + unit);
+        return;
+    }
+
+    Issue();
+    GLCall(glActiveTexture(GL_TEXTURE0 + unit));
+    s_State.ActiveUnit = unit;
+}
+
+void GLState::BindTexture(unsigned int unit, unsigned int target, unsigned int texture)
+{
+    int slot = FindTarget(s_TextureTargets, s_TextureTargetCount, target);
+    bool cached = slot >= 0 && unit < MaxTextureUnits;
+    if (cached && s_State.Textures[unit][slot] == texture) // Already bound, not even the unit has to change
+    {
+        Skip();
+#ifdef GLSTATE_VALIDATE
+        ASSERT(QueryTextureBinding(unit, s_TextureTargets[slot].Binding) == texture);
+#endif
+        return;
+    }
+
+    ActiveTexture(unit);
+    Issue();
+    GLCall(glBindTexture(target, texture));
+    if (cached)
+        s_State.Textures[unit][slot] = texture;
+}
+
+void GLState::BindTexture(unsigned int target, unsigned int texture)
+{
+    if (s_State.ActiveUnit == s_Unknown)
+        ActiveTexture(0);
+
+    BindTexture(s_State.ActiveUnit, target, texture);
+}
+
+void GLState::BindSampler(unsigned int unit, unsigned int sampler)
+{
+    bool cached = unit < MaxTextureUnits;
+    if (cached && s_State.Samplers[unit] == sampler)
+    {
+        Skip();
+#ifdef GLSTATE_VALIDATE
+        ASSERT(QueryTextureBinding(unit, GL_SAMPLER_BINDING) == sampler);
+#endif
+        return;
+    }
+
+    Issue();
+    GLCall(glBindSampler(unit, sampler)); // Takes the unit itself, the active unit is left alone
+    if (cached)
+        s_State.Samplers[unit] = sampler;
+}
+
+void GLState::SetBlend(bool enabled)
+{
+    if (s_State.Blend == (unsigned int)enabled)
+    {
+        Skip();
+        GLSTATE_CHECK(GL_BLEND, (unsigned int)enabled);
+        return;
+    }
+
+    Issue();
+    if (enabled)
+    {
+        GLCall(glEnable(GL_BLEND));
+    }
+    else
+    {
+        GLCall(glDisable(GL_BLEND));
+    }
+    s_State.Blend = enabled;
+}
+
+void GLState::BlendFunc(unsigned int sfactor, unsigned int dfactor)
+{
+    if (s_State.BlendSrc == sfactor && s_State.BlendDst == dfactor)
+    {
+        Skip();
+        GLSTATE_CHECK(GL_BLEND_SRC_RGB, sfactor);
+        GLSTATE_CHECK(GL_BLEND_DST_RGB, dfactor);
+        return;
+    }
+
+    Issue();
+    GLCall(glBlendFunc(sfactor, dfactor));
+    s_State.BlendSrc = sfactor;
+    s_State.BlendDst = dfactor;
+}
+
+void GLState::OnProgramDeleted(unsigned int program)
+{
+    if (s_State.Program == program)
+        s_State.Program = s_Unknown; // Stays in use until something else is bound, but don't count on it
+}
+
+void GLState::OnProgramPipelineDeleted(unsigned int pipeline)
+{
+    if (s_State.ProgramPipeline == pipeline)
+        s_State.ProgramPipeline = 0; // Unlike programs, deleting the bound pipeline unbinds it
+}
+
+void GLState::OnVertexArrayDeleted(unsigned int vertexArray)
+{
+    if (s_State.VertexArray == vertexArray)
+        s_State.VertexArray = 0;
+    s_State.ElementBuffers.erase(vertexArray);
+}
+
+void GLState::OnBufferDeleted(unsigned int buffer)
+{
+    for (unsigned int i = 0; i < s_BufferTargetCount; i++)
+    {
+        if (s_State.Buffers[i] == buffer)
+            s_State.Buffers[i] = 0;
+    }
+    for (unsigned int i = 0; i < s_IndexedTargetCount; i++)
+    {
+        for (unsigned int index = 0; index < MaxBufferBindings; index++)
+        {
+            if (s_State.IndexedBuffers[i][index].Buffer != buffer)
+                continue;
+            s_State.IndexedBuffers[i][index] = { 0, 0, 0 };
+
+            // Some drivers (Mesa) unbind indexed bindings like a BindBufferBase with 0, which resets the generic binding too
+            int generic = FindTarget(s_BufferTargets, s_BufferTargetCount, s_IndexedTargets[i].Target);
+            if (generic >= 0)
+                s_State.Buffers[generic] = s_Unknown;
+        }
+    }
+
+    // Only the bound VAO drops the reference, others keep pointing at a dead name so forget them all
+    for (auto it = s_State.ElementBuffers.begin(); it != s_State.ElementBuffers.end();)
+    {
+        if (it->second == buffer)
+            it = s_State.ElementBuffers.erase(it);
+        else
+            ++it;
+    }
+}
+
+void GLState::OnTextureDeleted(unsigned int texture)
+{
+    for (unsigned int unit = 0; unit < MaxTextureUnits; unit++)
+    {
+        for (unsigned int i = 0; i < s_TextureTargetCount; i++)
+        {
+            if (s_State.Textures[unit][i] == texture)
+                s_State.Textures[unit][i] = 0;
+        }
+    }
+}
+
+void GLState::OnSamplerDeleted(unsigned int sampler)
+{
+    for (unsigned int unit = 0; unit < MaxTextureUnits; unit++)
+    {
+        if (s_State.Samplers[unit] == sampler)
+            s_State.Samplers[unit] = 0;
+    }
+}
+
+void GLState::Invalidate()
+{
+    s_State.Reset();
+}
+
+bool GLState::Validate()
+{
+    bool valid = true;
+    auto check = [&valid](GLenum pname, unsigned int expected, const char* name)
+    {
+        if (expected == s_Unknown)
+            return;
+
+        int value = 0;
+        GLCall(glGetIntegerv(pname, &value));
+        if ((unsigned int)value != expected)
+        {
+            std::cout << "[GLState] " << name << " is " << value << " but the cache has " << expected << std::endl;
+            valid = false;
+        }
+    };
+
+    check(GL_CURRENT_PROGRAM, s_State.Program, "GL_CURRENT_PROGRAM");
+    check(GL_PROGRAM_PIPELINE_BINDING, s_State.ProgramPipeline, "GL_PROGRAM_PIPELINE_BINDING"); // Stays unknown without pipelines, so never queried there
+    check(GL_VERTEX_ARRAY_BINDING, s_State.VertexArray, "GL_VERTEX_ARRAY_BINDING");
+    for (unsigned int i = 0; i < s_BufferTargetCount; i++)
+        check(s_BufferTargets[i].Binding, s_State.Buffers[i], "buffer binding");
+    for (unsigned int i = 0; i < s_IndexedTargetCount; i++)
+    {
+        for (unsigned int index = 0; index < MaxBufferBindings; index++)
+        {
+            unsigned int expected = s_State.IndexedBuffers[i][index].Buffer;
+            if (expected != s_Unknown && QueryIndexedBinding(s_IndexedTargets[i].Binding, index) != expected)
+            {
+                std::cout << "[GLState] indexed buffer binding " << index << " does not match the cache (" << expected << ")" << std::endl;
+                valid = false;
+            }
+        }
+    }
+    if (s_State.VertexArray != s_Unknown)
+    {
+        auto it = s_State.ElementBuffers.find(s_State.VertexArray);
+        if (it != s_State.ElementBuffers.end())
+            check(GL_ELEMENT_ARRAY_BUFFER_BINDING, it->second, "GL_ELEMENT_ARRAY_BUFFER_BINDING");
+    }
+    if (s_State.Blend != s_Unknown)
+    {
+        GLboolean blend;
+        GLCall(glGetBooleanv(GL_BLEND, &blend));
+        if (blend != (GLboolean)s_State.Blend)
+        {
+            std::cout << "[GLState] GL_BLEND is " << (int)blend << " but the cache has " << s_State.Blend << std::endl;
+            valid = false;
+        }
+    }
+    check(GL_BLEND_SRC_RGB, s_State.BlendSrc, "GL_BLEND_SRC_RGB");
+    check(GL_BLEND_DST_RGB, s_State.BlendDst, "GL_BLEND_DST_RGB");
+
+    int active = 0;
+    GLCall(glGetIntegerv(GL_ACTIVE_TEXTURE, &active));
+    if (s_State.ActiveUnit != s_Unknown && (unsigned int)active != GL_TEXTURE0 + s_State.ActiveUnit)
+    {
+        std::cout << "[GLState] GL_ACTIVE_TEXTURE is unit " << active - GL_TEXTURE0 << " but the cache has " << s_State.ActiveUnit << std::endl;
+        valid = false;
+    }
+    for (unsigned int unit = 0; unit < MaxTextureUnits; unit++)
+    {
+        for (unsigned int i = 0; i < s_TextureTargetCount; i++)
+        {
+            if (s_State.Textures[unit][i] == s_Unknown)
+                continue;
+
+            GLCall(glActiveTexture(GL_TEXTURE0 + unit));
+            check(s_TextureTargets[i].Binding, s_State.Textures[unit][i], "texture binding");
+        }
+        if (s_State.Samplers[unit] != s_Unknown)
+        {
+            GLCall(glActiveTexture(GL_TEXTURE0 + unit));
+            check(GL_SAMPLER_BINDING, s_State.Samplers[unit], "sampler binding");
+        }
+    }
+    GLCall(glActiveTexture(active)); // Restore, the cache has not changed
+
+    return valid;
+}
+
+const GLStateCounters& GLState::GetCounters()
+{
+    return s_State.Counters;
+}
+
+void GLState::ResetCounters()
+{
+    s_State.Counters = GLStateCounters();
+}
+
+unsigned int GLState::GetActiveTexture()
+{
+    return s_State.ActiveUnit;
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include "GLPrerequisites.h"
+
+/*
+Shadow copy of the GL binding state. Every bind in the wrapper classes goes through here so a
+call that would not change anything is skipped instead of reaching the driver.
+
+Raw glBind* / glUseProgram / glActiveTexture / glEnable(GL_BLEND) calls made outside of GLState
+leave the cache stale, call Invalidate() afterwards if they can't be avoided.
+
+Define GLSTATE_VALIDATE (on in Debug builds) to check every skipped call against glGet*.
+*/
+
+struct GLStateCounters
+{
+	unsigned int Issued = 0;
+	unsigned int Skipped = 0;
+};
+
+class GLState
+{
+public:
+	static const unsigned int MaxTextureUnits = 32; // Units past this are passed straight through
+	static const unsigned int MaxBufferBindings = 16; // Indexed uniform/storage binding points, same as above
+private:
+	GLState() {} // Static only, there is exactly one GL context
+public:
+	static void UseProgram(unsigned int program);
+	static void BindProgramPipeline(unsigned int pipeline); // Also makes program 0 current, a current program overrides the pipeline
+	static void BindVertexArray(unsigned int vertexArray);
+	static void BindBuffer(unsigned int target, unsigned int buffer);
+	static void BindBufferBase(unsigned int target, unsigned int index, unsigned int buffer); // GL_UNIFORM_BUFFER or GL_SHADER_STORAGE_BUFFER binding points
+	static void BindBufferRange(unsigned int target, unsigned int index, unsigned int buffer, GLintptr offset, GLsizeiptr size);
+	static void ActiveTexture(unsigned int unit); // Unit index, not GL_TEXTURE0 + unit
+	static void BindTexture(unsigned int unit, unsigned int target, unsigned int texture);
+	static void BindTexture(unsigned int target, unsigned int texture); // On the currently active unit
+	static void BindSampler(unsigned int unit, unsigned int sampler); // 0 to go back to the bound texture's own parameters
+	static void SetBlend(bool enabled);
+	static void BlendFunc(unsigned int sfactor, unsigned int dfactor);
+
+	// GL silently unbinds deleted objects and reuses their names, so the cache has to hear about deletes
+	static void OnProgramDeleted(unsigned int program);
+	static void OnProgramPipelineDeleted(unsigned int pipeline);
+	static void OnVertexArrayDeleted(unsigned int vertexArray);
+	static void OnBufferDeleted(unsigned int buffer);
+	static void OnTextureDeleted(unsigned int texture);
+	static void OnSamplerDeleted(unsigned int sampler);
+
+	static void Invalidate(); // Forget everything, the next call of each kind always reaches GL
+	static bool Validate(); // Compares the whole cache against glGet*, prints and returns false on a mismatch
+
+	static const GLStateCounters& GetCounters();
+	static void ResetCounters();
+
+	static unsigned int GetActiveTexture();
+};
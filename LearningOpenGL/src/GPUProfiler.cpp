@@ -0,0 +1,163 @@
+#include "GPUProfiler.h"
+
+#include <iostream>
+
+GPUProfiler::GPUProfiler()
+	: m_FrameIndex(0), m_DebugGroups(GLEW_VERSION_4_3 || GLEW_KHR_debug), m_DroppedFrames(0)
+{
+}
+
+GPUProfiler::~GPUProfiler()
+{
+	for (FrameQueries& frame : m_Frames)
+	{
+		if (!frame.Queries.empty())
+		{
+			GLCall(glDeleteQueries((GLsizei)frame.Queries.size(), frame.Queries.data()));
+		}
+	}
+}
+
+void GPUProfiler::BeginFrame()
+{
+	m_FrameIndex = (m_FrameIndex + 1) % FramesInFlight;
+	FrameQueries& frame = m_Frames[m_FrameIndex];
+
+	if (frame.Pending) // Issued FramesInFlight frames ago, should be done by now
+		Collect(frame);
+
+	frame.Used = 0;
+	frame.Scopes.clear();
+	frame.Pending = true;
+	m_OpenScopes.clear();
+
+	BeginScope("Frame");
+}
+
+void GPUProfiler::EndFrame()
+{
+	while (!m_OpenScopes.empty()) // Frame scope, plus anything left open by mistake
+		EndScope();
+}
+
+void GPUProfiler::BeginScope(const char* name)
+{
+	FrameQueries& frame = m_Frames[m_FrameIndex];
+
+	PendingScope scope;
+	scope.Name = name;
+	scope.Depth = (unsigned int)m_OpenScopes.size();
+	scope.BeginQuery = NextQuery(frame);
+	scope.EndQuery = 0;
+	GLCall(glQueryCounter(frame.Queries[scope.BeginQuery], GL_TIMESTAMP));
+
+	m_OpenScopes.push_back((unsigned int)frame.Scopes.size());
+	frame.Scopes.push_back(scope);
+
+	if (m_DebugGroups)
+	{
+		GLCall(glPushDebugGroup(GL_DEBUG_SOURCE_APPLICATION, 0, -1, name));
+	}
+}
+
+void GPUProfiler::EndScope()
+{
+	if (m_OpenScopes.empty())
+		return;
+
+	if (m_DebugGroups)
+	{
+		GLCall(glPopDebugGroup());
+	}
+
+	FrameQueries& frame = m_Frames[m_FrameIndex];
+	PendingScope& scope = frame.Scopes[m_OpenScopes.back()];
+	m_OpenScopes.pop_back();
+
+	scope.EndQuery = NextQuery(frame);
+	GLCall(glQueryCounter(frame.Queries[scope.EndQuery], GL_TIMESTAMP));
+}
+
+double GPUProfiler::GetAverage(const std::string& name) const
+{
+	auto it = m_Averages.find(name);
+	if (it == m_Averages.end() || it->second.Count == 0)
+		return 0.0;
+
+	return it->second.Sum / it->second.Count;
+}
+
+void GPUProfiler::PrintLastFrame() const
+{
+	for (const GPUScopeRecord& record : m_LastFrame)
+	{
+		std::cout << "[GPU] " << std::string(record.Depth * 2, ' ') << record.Name << " : "
+			<< record.Milliseconds << " ms (avg " << GetAverage(record.Name) << " ms)" << std::endl;
+	}
+}
+
+unsigned int GPUProfiler::NextQuery(FrameQueries& frame)
+{
+	if (frame.Used == frame.Queries.size())
+	{
+		unsigned int query;
+		GLCall(glGenQueries(1, &query));
+		frame.Queries.push_back(query);
+	}
+	return frame.Used++;
+}
+
+void GPUProfiler::Collect(FrameQueries& frame)
+{
+	frame.Pending = false;
+	if (frame.Used == 0)
+		return;
+
+	// Queries finish in order, so if the last one is ready they all are
+	int available = 0;
+	GLCall(glGetQueryObjectiv(frame.Queries[frame.Used - 1], GL_QUERY_RESULT_AVAILABLE, &available));
+	if (!available)
+	{
+		m_DroppedFrames++;
+		return;
+	}
+
+	m_LastFrame.clear();
+	for (const PendingScope& scope : frame.Scopes)
+	{
+		GLuint64 begin = 0, end = 0;
+		GLCall(glGetQueryObjectui64v(frame.Queries[scope.BeginQuery], GL_QUERY_RESULT, &begin));
+		GLCall(glGetQueryObjectui64v(frame.Queries[scope.EndQuery], GL_QUERY_RESULT, &end));
+
+		double milliseconds = (end - begin) / 1000000.0;
+		m_LastFrame.push_back({ scope.Name, scope.Depth, milliseconds });
+
+		RollingAverage& average = m_Averages[scope.Name];
+		if (average.Count == AverageWindow)
+			average.Sum -= average.Samples[average.Next];
+		else
+			average.Count++;
+		average.Samples[average.Next] = milliseconds;
+		average.Sum += milliseconds;
+		average.Next = (average.Next + 1) % AverageWindow;
+	}
+}
+
+GPUProfileScope::GPUProfileScope(GPUProfiler* profiler, const char* name)
+	: m_Profiler(profiler)
+{
+	if (m_Profiler)
+		m_Profiler->BeginScope(name);
+}
+
+GPUProfileScope::GPUProfileScope(GPUProfileScope&& other)
+	: m_Profiler(other.m_Profiler)
+{
+	other.m_Profiler = nullptr;
+}
+
+GPUProfileScope::~GPUProfileScope()
+{
+	if (m_Profiler)
+		m_Profiler->EndScope();
+}
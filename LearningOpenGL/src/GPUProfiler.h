@@ -0,0 +1,92 @@
+#pragma once
+
+#include "GLPrerequisites.h"
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+struct GPUScopeRecord
+{
+	const char* Name;
+	unsigned int Depth; // 0 is the whole frame
+	double Milliseconds;
+};
+
+/*
+Times named, nestable scopes on the GPU with glQueryCounter(GL_TIMESTAMP) pairs. Results are read
+FramesInFlight frames later, by which point the GPU has normally finished them, so reading never stalls.
+If it hasn't, that frame is dropped instead of waited on.
+
+Scopes also show up as KHR_debug groups in RenderDoc, Nsight etc. when the extension is there.
+Scope names must outlive the profiler, string literals are what it expects.
+*/
+class GPUProfiler
+{
+public:
+	static const unsigned int FramesInFlight = 3;
+	static const unsigned int AverageWindow = 60; // Frames
+private:
+	struct PendingScope
+	{
+		const char* Name;
+		unsigned int Depth;
+		unsigned int BeginQuery; // Indices into FrameQueries::Queries
+		unsigned int EndQuery;
+	};
+
+	struct FrameQueries
+	{
+		std::vector<unsigned int> Queries; // Grows as needed, never shrinks
+		unsigned int Used = 0;
+		std::vector<PendingScope> Scopes;
+		bool Pending = false;
+	};
+
+	struct RollingAverage
+	{
+		double Samples[AverageWindow] = {};
+		unsigned int Count = 0;
+		unsigned int Next = 0;
+		double Sum = 0.0;
+	};
+
+	FrameQueries m_Frames[FramesInFlight];
+	unsigned int m_FrameIndex;
+	std::vector<unsigned int> m_OpenScopes; // Stack of indices into the current frame's Scopes
+	bool m_DebugGroups;
+
+	std::vector<GPUScopeRecord> m_LastFrame;
+	std::unordered_map<std::string, RollingAverage> m_Averages;
+	unsigned int m_DroppedFrames;
+public:
+	GPUProfiler();
+	~GPUProfiler();
+
+	void BeginFrame(); // Also collects the results of the frame FramesInFlight ago
+	void EndFrame();
+
+	void BeginScope(const char* name);
+	void EndScope();
+
+	inline const std::vector<GPUScopeRecord>& GetLastFrame() const { return m_LastFrame; } // Most recent frame with results, in begin order
+	double GetAverage(const std::string& name) const; // Milliseconds over the last AverageWindow frames, 0 if never seen
+	inline unsigned int GetDroppedFrames() const { return m_DroppedFrames; }
+	void PrintLastFrame() const;
+private:
+	unsigned int NextQuery(FrameQueries& frame);
+	void Collect(FrameQueries& frame);
+};
+
+class GPUProfileScope // RAII helper, see Renderer::Scope
+{
+private:
+	GPUProfiler* m_Profiler;
+public:
+	GPUProfileScope(GPUProfiler* profiler, const char* name);
+	GPUProfileScope(GPUProfileScope&& other); // Movable so it can be returned, the moved-from scope does nothing
+	~GPUProfileScope();
+
+	GPUProfileScope(const GPUProfileScope&) = delete;
+	GPUProfileScope& operator=(const GPUProfileScope&) = delete;
+};
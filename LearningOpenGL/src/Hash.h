@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+/*
+64-bit FNV-1a for cache keys and content hashes. Always 64 bits, so hashes written to disk are the same
+on Win32 and x64; Fold narrows one to size_t for std::unordered_map. Chain calls by passing the previous
+result back in:
+
+	uint64_t hash = Hash::FNV1a(name.data(), name.size());
+	hash = Hash::FNV1a(&size, sizeof(size), hash);
+*/
+class Hash
+{
+public:
+	static const uint64_t FNVOffsetBasis = 14695981039346656037ull;
+	static const uint64_t FNVPrime = 1099511628211ull;
+
+	Hash() {} // Static only
+
+	static inline uint64_t FNV1a(const void* data, size_t size, uint64_t hash = FNVOffsetBasis)
+	{
+		const unsigned char* bytes = (const unsigned char*)data;
+		for (size_t i = 0; i < size; i++)
+		{
+			hash ^= bytes[i];
+			hash *= FNVPrime;
+		}
+		return hash;
+	}
+
+	static inline size_t Fold(uint64_t hash) // Keeps the high bits' influence where size_t is 32 bits
+	{
+		return sizeof(size_t) >= sizeof(uint64_t) ? (size_t)hash : (size_t)(hash ^ (hash >> 32));
+	}
+};
@@ -0,0 +1,160 @@
+#include "HeadlessContext.h"
+
+#include "GLPrerequisites.h"
+
+#include <iostream>
+
+#ifdef _WIN32
+#include <GLFW/glfw3.h>
+#else
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+
+#ifndef EGL_PLATFORM_SURFACELESS_MESA
+#define EGL_PLATFORM_SURFACELESS_MESA 0x31DD
+#endif
+#endif
+
+HeadlessContext::HeadlessContext()
+	: m_Display(nullptr), m_Context(nullptr)
+{
+}
+
+HeadlessContext::~HeadlessContext()
+{
+	Destroy();
+}
+
+bool HeadlessContext::Create(int majorVersion, int minorVersion)
+{
+	GLContextVersion version = { majorVersion, minorVersion };
+	return Create(&version, 1);
+}
+
+#ifdef _WIN32
+
+bool HeadlessContext::Create(const GLContextVersion* versions, unsigned int count)
+{
+	if (!glfwInit())
+		return false;
+
+	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+	glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+
+	GLFWwindow* window = nullptr;
+	for (unsigned int i = 0; i < count && !window; i++)
+	{
+		glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, versions[i].Major);
+		glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, versions[i].Minor);
+		window = glfwCreateWindow(1, 1, "Headless", NULL, NULL); // Never shown, only here to own the context
+	}
+	if (!window)
+	{
+		std::cout << "Failed to create hidden window for headless context!" << std::endl;
+		glfwTerminate();
+		return false;
+	}
+
+	glfwMakeContextCurrent(window);
+	m_Display = window;
+	m_Context = window;
+	return true;
+}
+
+void HeadlessContext::Destroy()
+{
+	if (!m_Context)
+		return;
+
+	glfwDestroyWindow((GLFWwindow*)m_Context);
+	glfwTerminate();
+	m_Display = nullptr;
+	m_Context = nullptr;
+}
+
+#else
+
+bool HeadlessContext::Create(const GLContextVersion* versions, unsigned int count)
+{
+	EGLDisplay display = EGL_NO_DISPLAY;
+	PFNEGLGETPLATFORMDISPLAYEXTPROC getPlatformDisplay = (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+	if (getPlatformDisplay)
+		display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+	if (display == EGL_NO_DISPLAY)
+		display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+
+	EGLint major, minor;
+	if (display == EGL_NO_DISPLAY || !eglInitialize(display, &major, &minor))
+	{
+		std::cout << "Failed to initialise EGL display!" << std::endl;
+		return false;
+	}
+
+	if (!eglBindAPI(EGL_OPENGL_API))
+	{
+		std::cout << "EGL display has no desktop OpenGL support!" << std::endl;
+		eglTerminate(display);
+		return false;
+	}
+
+	const EGLint configAttribs[] =
+	{
+		EGL_SURFACE_TYPE, EGL_PBUFFER_BIT, // The surfaceless platform has no window configs
+		EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+		EGL_RED_SIZE, 8, EGL_GREEN_SIZE, 8, EGL_BLUE_SIZE, 8, EGL_ALPHA_SIZE, 8,
+		EGL_NONE
+	};
+	EGLConfig config;
+	EGLint configCount = 0;
+	if (!eglChooseConfig(display, configAttribs, &config, 1, &configCount) || configCount == 0)
+	{
+		std::cout << "No suitable EGL config!" << std::endl;
+		eglTerminate(display);
+		return false;
+	}
+
+	EGLContext context = EGL_NO_CONTEXT;
+	for (unsigned int i = 0; i < count && context == EGL_NO_CONTEXT; i++) // Unsupported versions just fail with EGL_BAD_MATCH
+	{
+		const EGLint contextAttribs[] =
+		{
+			EGL_CONTEXT_MAJOR_VERSION, versions[i].Major,
+			EGL_CONTEXT_MINOR_VERSION, versions[i].Minor,
+			EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+			EGL_NONE
+		};
+		context = eglCreateContext(display, config, EGL_NO_CONTEXT, contextAttribs);
+	}
+	if (context == EGL_NO_CONTEXT)
+	{
+		std::cout << "Failed to create EGL context!" << std::endl;
+		eglTerminate(display);
+		return false;
+	}
+
+	if (!eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, context)) // Needs EGL_KHR_surfaceless_context
+	{
+		std::cout << "Failed to make EGL context current without a surface!" << std::endl;
+		eglDestroyContext(display, context);
+		eglTerminate(display);
+		return false;
+	}
+
+	m_Display = display;
+	m_Context = context;
+	return true;
+}
+
+void HeadlessContext::Destroy()
+{
+	if (!m_Context)
+		return;
+
+	eglMakeCurrent((EGLDisplay)m_Display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+	eglDestroyContext((EGLDisplay)m_Display, (EGLContext)m_Context);
+	eglTerminate((EGLDisplay)m_Display);
+	m_Display = nullptr;
+	m_Context = nullptr;
+}
+
+#endif
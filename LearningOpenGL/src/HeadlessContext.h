@@ -0,0 +1,26 @@
+#pragma once
+
+struct GLContextVersion;
+
+/*
+GL context with no window, for CI and render-farm machines without a display or GPU.
+
+Linux uses EGL on Mesa's surfaceless platform (works with llvmpipe, set LIBGL_ALWAYS_SOFTWARE=1 to force it),
+falling back to the default EGL display. Windows has no EGL so it falls back to a hidden GLFW window.
+There is no default framebuffer to draw into either way, render into a Framebuffer.
+*/
+class HeadlessContext
+{
+private:
+	void* m_Display; // EGLDisplay, or the hidden GLFWwindow on Windows
+	void* m_Context;
+public:
+	HeadlessContext();
+	~HeadlessContext();
+
+	bool Create(int majorVersion, int minorVersion); // Creates the context and makes it current
+	bool Create(const GLContextVersion* versions, unsigned int count); // Same, with the first version in the list the driver accepts
+	void Destroy();
+
+	inline bool IsValid() const { return m_Context != nullptr; }
+};
\ No newline at end of file
@@ -0,0 +1,54 @@
+#include "ImageCompare.h"
+
+#include <cstdlib>
+#include <iostream>
+
+#include "stb_image.h"
+
+ImageDifference ImageCompare::Compare(const std::string& referencePath, int width, int height, const unsigned char* rgba, int tolerance)
+{
+    ImageDifference difference;
+
+    int referenceWidth, referenceHeight, channels;
+    stbi_set_flip_vertically_on_load_thread(1); // Bottom row first, like the readback
+    unsigned char* reference = stbi_load(referencePath.c_str(), &referenceWidth, &referenceHeight, &channels, 4);
+    if (!reference)
+    {
+        std::cout << "Failed to load reference image '" << referencePath << "'!" << std::endl;
+        return difference;
+    }
+
+    if (referenceWidth != width || referenceHeight != height)
+    {
+        std::cout << "Reference image '" << referencePath << "' is " << referenceWidth << "x" << referenceHeight
+                  << ", the frame is " << width << "x" << height << "!" << std::endl;
+        stbi_image_free(reference);
+        return difference;
+    }
+
+    difference.Loaded = true;
+    difference.PixelCount = (unsigned int)width * height;
+    for (unsigned int pixel = 0; pixel < difference.PixelCount; pixel++)
+    {
+        int pixelDifference = 0;
+        for (int channel = 0; channel < 4; channel++)
+        {
+            int channelDifference = std::abs((int)rgba[pixel * 4 + channel] - (int)reference[pixel * 4 + channel]);
+            if (channelDifference > pixelDifference)
+                pixelDifference = channelDifference;
+        }
+
+        if (pixelDifference > difference.MaxChannelDifference)
+            difference.MaxChannelDifference = pixelDifference;
+        if (pixelDifference > tolerance)
+            difference.DifferentPixels++;
+    }
+
+    stbi_image_free(reference);
+    return difference;
+}
+
+bool ImageCompare::Passes(const ImageDifference& difference, float maxDifferentFraction)
+{
+    return difference.Loaded && difference.DifferentPixels <= (unsigned int)(difference.PixelCount * maxDifferentFraction);
+}
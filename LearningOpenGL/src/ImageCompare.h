@@ -0,0 +1,26 @@
+#pragma once
+
+#include <string>
+
+struct ImageDifference
+{
+	bool Loaded = false; // False when the reference could not be read or its size does not match
+	int MaxChannelDifference = 0;
+	unsigned int DifferentPixels = 0; // Pixels with any channel further off than the tolerance
+	unsigned int PixelCount = 0;
+};
+
+/* Compares a readback against a reference PNG, for checking headless runs against res/reference.
+   Drivers rasterize slightly differently, so small per-channel errors are tolerated and only a share of the pixels may exceed them:
+
+	ImageDifference difference = ImageCompare::Compare("res/reference/headless.png", width, height, pixels.data(), 8);
+	bool passed = ImageCompare::Passes(difference, 0.001f);
+*/
+class ImageCompare
+{
+public:
+	ImageCompare() {} // Static only
+
+	static ImageDifference Compare(const std::string& referencePath, int width, int height, const unsigned char* rgba, int tolerance); // rgba rows bottom-up as read back
+	static bool Passes(const ImageDifference& difference, float maxDifferentFraction);
+};
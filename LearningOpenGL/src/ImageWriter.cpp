@@ -0,0 +1,122 @@
+#include "ImageWriter.h"
+
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+// Minimal PNG encoder: the image data goes into uncompressed ("stored") deflate blocks, so no zlib is needed.
+// Files come out about as big as the raw pixels, which is fine for test and CI output
+
+static unsigned int Crc32(const unsigned char* data, size_t size, unsigned int crc = 0xFFFFFFFF)
+{
+    static unsigned int table[256];
+    static bool tableReady = false;
+    if (!tableReady)
+    {
+        for (unsigned int n = 0; n < 256; n++)
+        {
+            unsigned int c = n;
+            for (int k = 0; k < 8; k++)
+                c = (c & 1) ? 0xEDB88320 ^ (c >> 1) : c >> 1;
+            table[n] = c;
+        }
+        tableReady = true;
+    }
+
+    for (size_t i = 0; i < size; i++)
+        crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    return crc;
+}
+
+static void PutU32(std::vector<unsigned char>& out, unsigned int value) // PNG is big endian
+{
+    out.push_back((value >> 24) & 0xFF);
+    out.push_back((value >> 16) & 0xFF);
+    out.push_back((value >> 8) & 0xFF);
+    out.push_back(value & 0xFF);
+}
+
+static void WriteChunk(std::ofstream& stream, const char* type, const std::vector<unsigned char>& data)
+{
+    std::vector<unsigned char> chunk;
+    PutU32(chunk, (unsigned int)data.size());
+    chunk.insert(chunk.end(), type, type + 4);
+    chunk.insert(chunk.end(), data.begin(), data.end());
+    unsigned int crc = Crc32(chunk.data() + 4, chunk.size() - 4) ^ 0xFFFFFFFF; // CRC covers type and data, not the length
+    PutU32(chunk, crc);
+    stream.write((const char*)chunk.data(), chunk.size());
+}
+
+bool ImageWriter::WritePNG(const std::string& path, int width, int height, const unsigned char* rgba)
+{
+    std::ofstream stream(path, std::ios::binary);
+    if (!stream)
+    {
+        std::cout << "Failed to open '" << path << "' for writing!" << std::endl;
+        return false;
+    }
+
+    const unsigned char signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+    stream.write((const char*)signature, sizeof(signature));
+
+    std::vector<unsigned char> header;
+    PutU32(header, width);
+    PutU32(header, height);
+    header.push_back(8); // Bit depth
+    header.push_back(6); // Colour type RGBA
+    header.push_back(0); // Compression
+    header.push_back(0); // Filter
+    header.push_back(0); // Interlace
+    WriteChunk(stream, "IHDR", header);
+
+    // Scanlines top to bottom, each prefixed with filter type 0 (none)
+    const size_t rowSize = (size_t)width * 4;
+    std::vector<unsigned char> scanlines;
+    scanlines.reserve((rowSize + 1) * height);
+    for (int y = height - 1; y >= 0; y--)
+    {
+        scanlines.push_back(0);
+        scanlines.insert(scanlines.end(), rgba + y * rowSize, rgba + (y + 1) * rowSize);
+    }
+
+    std::vector<unsigned char> zlib;
+    zlib.push_back(0x78); // Deflate, 32K window
+    zlib.push_back(0x01); // No preset dictionary, check bits
+    size_t offset = 0;
+    do // Stored blocks hold at most 65535 bytes each
+    {
+        size_t blockSize = scanlines.size() - offset < 65535 ? scanlines.size() - offset : 65535;
+        zlib.push_back(offset + blockSize == scanlines.size() ? 1 : 0); // Final block flag, block type 00 (stored)
+        zlib.push_back(blockSize & 0xFF);
+        zlib.push_back((blockSize >> 8) & 0xFF);
+        zlib.push_back(~blockSize & 0xFF);
+        zlib.push_back((~blockSize >> 8) & 0xFF);
+        zlib.insert(zlib.end(), scanlines.begin() + offset, scanlines.begin() + offset + blockSize);
+        offset += blockSize;
+    } while (offset < scanlines.size());
+
+    unsigned int a = 1, b = 0; // Adler-32 of the uncompressed data
+    for (unsigned char byte : scanlines)
+    {
+        a = (a + byte) % 65521;
+        b = (b + a) % 65521;
+    }
+    PutU32(zlib, (b << 16) | a);
+    WriteChunk(stream, "IDAT", zlib);
+
+    WriteChunk(stream, "IEND", std::vector<unsigned char>());
+    return stream.good();
+}
+
+bool ImageWriter::WriteRaw(const std::string& path, int width, int height, const unsigned char* rgba)
+{
+    std::ofstream stream(path, std::ios::binary);
+    if (!stream)
+    {
+        std::cout << "Failed to open '" << path << "' for writing!" << std::endl;
+        return false;
+    }
+
+    stream.write((const char*)rgba, (std::streamsize)width * height * 4); // As read back, bottom row first
+    return stream.good();
+}
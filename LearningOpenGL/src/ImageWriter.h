@@ -0,0 +1,10 @@
+#pragma once
+
+#include <string>
+
+class ImageWriter // Dumps RGBA8 readbacks to disk, rows are expected bottom-up as glReadPixels returns them
+{
+public:
+	static bool WritePNG(const std::string& path, int width, int height, const unsigned char* rgba);
+	static bool WriteRaw(const std::string& path, int width, int height, const unsigned char* rgba);
+};
\ No newline at end of file
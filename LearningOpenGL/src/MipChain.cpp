@@ -0,0 +1,144 @@
+#include "MipChain.h"
+
+#include "CPUProfiler.h"
+
+#include <algorithm>
+#include <cmath>
+
+static const float s_KaiserWidth = 3.0f; // In destination texels either side, so 6 source texels when halving
+static const float s_KaiserAlpha = 4.0f;
+
+struct Tap
+{
+	int Index;
+	float Weight;
+};
+
+static float Bessel0(float x) // Modified Bessel function of the first kind, order 0, by its series
+{
+	float sum = 1.0f, term = 1.0f;
+	for (int k = 1; k < 32 && term > sum * 1e-8f; k++)
+	{
+		term *= (x / (2.0f * k)) * (x / (2.0f * k));
+		sum += term;
+	}
+	return sum;
+}
+
+static float Kaiser(float x) // x from -1 to 1 across the window
+{
+	return Bessel0(s_KaiserAlpha * std::sqrt(std::max(1.0f - x * x, 0.0f))) / Bessel0(s_KaiserAlpha);
+}
+
+static float Sinc(float x)
+{
+	const float pi = 3.14159265358979f;
+	return std::fabs(x) < 1e-6f ? 1.0f : std::sin(pi * x) / (pi * x);
+}
+
+static std::vector<std::vector<Tap>> KaiserTaps(int source, int destination) // Normalised weights for every destination texel along one axis
+{
+	float scale = (float)source / destination;
+	std::vector<std::vector<Tap>> taps(destination);
+	for (int d = 0; d < destination; d++)
+	{
+		float center = (d + 0.5f) * scale, sum = 0.0f;
+		for (int i = (int)std::floor(center - s_KaiserWidth * scale); i <= (int)std::ceil(center + s_KaiserWidth * scale); i++)
+		{
+			float u = (i + 0.5f - center) / scale;
+			if (std::fabs(u) >= s_KaiserWidth)
+				continue;
+
+			float weight = Sinc(u) * Kaiser(u / s_KaiserWidth);
+			taps[d].push_back({ std::min(std::max(i, 0), source - 1), weight });
+			sum += weight;
+		}
+		for (Tap& tap : taps[d])
+			tap.Weight /= sum;
+	}
+	return taps;
+}
+
+static std::vector<unsigned char> DownsampleBox(const unsigned char* rgba, int width, int height, int halfWidth, int halfHeight)
+{
+	std::vector<unsigned char> result((size_t)halfWidth * halfHeight * 4);
+	for (int y = 0; y < halfHeight; y++)
+	{
+		const unsigned char* row0 = rgba + (size_t)std::min(y * 2, height - 1) * width * 4;
+		const unsigned char* row1 = rgba + (size_t)std::min(y * 2 + 1, height - 1) * width * 4;
+		unsigned char* destination = &result[(size_t)y * halfWidth * 4];
+		for (int x = 0; x < halfWidth; x++)
+		{
+			int x0 = std::min(x * 2, width - 1) * 4, x1 = std::min(x * 2 + 1, width - 1) * 4;
+			for (int c = 0; c < 4; c++)
+				destination[x * 4 + c] = (unsigned char)((row0[x0 + c] + row0[x1 + c] + row1[x0 + c] + row1[x1 + c] + 2) / 4);
+		}
+	}
+	return result;
+}
+
+static std::vector<unsigned char> DownsampleKaiser(const unsigned char* rgba, int width, int height, int halfWidth, int halfHeight)
+{
+	// Separable, rows first into floats. The 4 channels of a texel are done together so the inner loops vectorise
+	std::vector<std::vector<Tap>> columnTaps = KaiserTaps(width, halfWidth), rowTaps = KaiserTaps(height, halfHeight);
+	std::vector<float> horizontal((size_t)halfWidth * height * 4);
+	for (int y = 0; y < height; y++)
+	{
+		const unsigned char* source = rgba + (size_t)y * width * 4;
+		float* destination = &horizontal[(size_t)y * halfWidth * 4];
+		for (int x = 0; x < halfWidth; x++)
+		{
+			float sum[4] = {};
+			for (const Tap& tap : columnTaps[x])
+			{
+				for (int c = 0; c < 4; c++)
+					sum[c] += source[tap.Index * 4 + c] * tap.Weight;
+			}
+			std::copy(sum, sum + 4, &destination[x * 4]);
+		}
+	}
+
+	std::vector<unsigned char> result((size_t)halfWidth * halfHeight * 4);
+	std::vector<float> row((size_t)halfWidth * 4);
+	for (int y = 0; y < halfHeight; y++)
+	{
+		std::fill(row.begin(), row.end(), 0.0f);
+		for (const Tap& tap : rowTaps[y])
+		{
+			const float* source = &horizontal[(size_t)tap.Index * halfWidth * 4];
+			for (size_t i = 0; i < row.size(); i++)
+				row[i] += source[i] * tap.Weight;
+		}
+
+		unsigned char* destination = &result[(size_t)y * halfWidth * 4];
+		for (size_t i = 0; i < row.size(); i++)
+			destination[i] = (unsigned char)std::min(std::max(row[i] + 0.5f, 0.0f), 255.0f); // The negative lobes ring past the input range at hard edges
+	}
+	return result;
+}
+
+std::vector<std::vector<unsigned char>> MipChain::Build(int width, int height, const unsigned char* rgba, MipFilter filter)
+{
+	PROFILE_FUNCTION();
+	std::vector<std::vector<unsigned char>> levels;
+	levels.emplace_back(rgba, rgba + (size_t)width * height * 4);
+	for (int level = 1; level < GetLevelCount(width, height); level++)
+		levels.push_back(Downsample(levels.back().data(), std::max(width >> (level - 1), 1), std::max(height >> (level - 1), 1), filter));
+	return levels;
+}
+
+std::vector<unsigned char> MipChain::Downsample(const unsigned char* rgba, int width, int height, MipFilter filter)
+{
+	int halfWidth = std::max(width >> 1, 1), halfHeight = std::max(height >> 1, 1);
+	if (filter == MipFilter::Kaiser)
+		return DownsampleKaiser(rgba, width, height, halfWidth, halfHeight);
+	return DownsampleBox(rgba, width, height, halfWidth, halfHeight);
+}
+
+int MipChain::GetLevelCount(int width, int height)
+{
+	int count = 1;
+	while (std::max(width >> (count - 1), height >> (count - 1)) > 1)
+		count++;
+	return count;
+}
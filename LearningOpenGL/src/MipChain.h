@@ -0,0 +1,29 @@
+#pragma once
+
+#include <vector>
+
+enum class MipFilter
+{
+	Box, // 2x2 average, fast, what glGenerateMipmap does on most drivers
+	Kaiser // Kaiser windowed sinc over 6 texels, sharper minified detail with less aliasing, for offline baking
+};
+
+/*
+CPU mip levels for RGBA8 images, for everything that has to know the levels before they are on the GPU
+(TextureStreamer keeps them to stream from, TextureCompressor encodes each one, Texture can upload them).
+Each level is filtered from the one above. An odd last row or column is repeated rather than dropped, the
+Kaiser filter clamps its taps at the edges the same way. Channels are filtered as stored, no sRGB decode.
+
+    std::vector<std::vector<unsigned char>> levels = MipChain::Build(width, height, pixels, MipFilter::Kaiser);
+    Texture sprite(width, height, levels);
+*/
+class MipChain
+{
+private:
+	MipChain() {} // Static only
+public:
+	static std::vector<std::vector<unsigned char>> Build(int width, int height, const unsigned char* rgba, MipFilter filter = MipFilter::Box); // Level 0 (a copy) down to 1x1
+	static std::vector<unsigned char> Downsample(const unsigned char* rgba, int width, int height, MipFilter filter = MipFilter::Box); // One level, max(width / 2, 1) by max(height / 2, 1)
+
+	static int GetLevelCount(int width, int height); // Down to 1x1, so 9 for 256x256
+};
@@ -0,0 +1,200 @@
+#include "RenderQueue.h"
+
+#include "CPUProfiler.h"
+
+#include <iostream>
+#include <utility>
+
+/*
+Sort key layout, most significant bit first:
+
+    opaque:      | layer : 8 | 0 : 1 | shader : 12 | texture : 12 | unused : 7 | depth : 24 |
+    translucent: | layer : 8 | 1 : 1 | inverted depth : 24 | shader : 12 | texture : 12 | unused : 7 |
+
+Opaque draws are grouped by state and then go front to back, translucent draws have to
+go back to front so depth wins over state for them.
+
+Shaders and textures go in as dense per-frame indices (the order they were first submitted in)
+rather than GL names, which grow without bound over a run and would alias once masked to 12 bits.
+*/
+uint64_t RenderQueue::MakeSortKey(const RenderCommand& command, unsigned int shaderIndex, unsigned int textureIndex)
+{
+    ASSERT(shaderIndex <= MaxSortIndex && textureIndex <= MaxSortIndex);
+    float depth = command.Depth < 0.0f ? 0.0f : (command.Depth > 1.0f ? 1.0f : command.Depth);
+    uint64_t depthBits = (uint64_t)(depth * 0xFFFFFF);
+    uint64_t shaderBits = shaderIndex;
+    uint64_t textureBits = textureIndex;
+
+    uint64_t key = (uint64_t)command.Layer << 56;
+    if (command.Translucent)
+    {
+        key |= (uint64_t)1 << 55;
+        key |= (0xFFFFFF - depthBits) << 31;
+        key |= shaderBits << 19;
+        key |= textureBits << 7;
+    }
+    else
+    {
+        key |= shaderBits << 43;
+        key |= textureBits << 31;
+        key |= depthBits;
+    }
+    return key;
+}
+
+RenderQueue::RenderQueue(unsigned int reserve)
+{
+    m_Commands.reserve(reserve);
+    m_Entries.reserve(reserve);
+    m_Scratch.reserve(reserve);
+}
+
+unsigned int RenderQueue::DenseIndex(std::unordered_map<unsigned int, unsigned int>& indices, unsigned int name)
+{
+    auto it = indices.find(name);
+    if (it != indices.end())
+        return it->second;
+
+    unsigned int index = (unsigned int)indices.size();
+    ASSERT(index < MaxSortIndex); // More distinct shaders or textures in one frame than the key has room for, textures need one spare for "none"
+    indices.emplace(name, index);
+    return index;
+}
+
+void RenderQueue::Submit(const RenderCommand& command)
+{
+    unsigned int shaderIndex = DenseIndex(m_ShaderIndices, command.Program->GetRendererID());
+    unsigned int textureIndex = command.TextureCount > 0 ? DenseIndex(m_TextureIndices, command.Textures[0]->GetRendererID()) + 1 : 0; // 0 is no texture
+    m_Entries.push_back({ MakeSortKey(command, shaderIndex, textureIndex), (unsigned int)m_Commands.size() });
+    m_Commands.push_back(command);
+}
+
+void RenderQueue::Execute()
+{
+    PROFILE_FUNCTION();
+    m_Stats = RenderQueueStats();
+    m_Stats.CommandCount = (unsigned int)m_Commands.size();
+    m_Stats.Submitted = CountStateChanges(m_Entries);
+
+    Sort();
+    m_Stats.Sorted = CountStateChanges(m_Entries);
+
+    Shader* lastShader = nullptr;
+    UniformHandle mvpUniform, colorUniform;
+    const VertexArray* lastVA = nullptr;
+    const IndexBuffer* lastIB = nullptr;
+    const Texture* lastTextures[RenderCommand::MaxTextures] = {};
+
+    for (const SortEntry& entry : m_Entries)
+    {
+        const RenderCommand& command = m_Commands[entry.Index];
+
+        if (command.Program != lastShader)
+        {
+            command.Program->Bind();
+            lastShader = command.Program;
+            mvpUniform = lastShader->GetUniform("u_MVP"); // Only on shader changes, which the sort keeps rare
+            colorUniform = lastShader->GetUniform("u_Color");
+        }
+        if (command.VA != lastVA)
+        {
+            command.VA->Bind();
+            lastVA = command.VA;
+            lastIB = nullptr; // The element buffer binding is part of the VAO state
+        }
+        if (command.IB != lastIB)
+        {
+            command.IB->Bind();
+            lastIB = command.IB;
+        }
+        for (unsigned int i = 0; i < command.TextureCount; i++)
+        {
+            if (command.Textures[i] != lastTextures[i])
+            {
+                command.Textures[i]->Bind(i);
+                lastTextures[i] = command.Textures[i];
+            }
+        }
+
+        lastShader->SetUniform(mvpUniform, command.MVP);
+        if (command.HasColor)
+            lastShader->SetUniform(colorUniform, command.Color);
+
+        GLCall(glDrawElements(GL_TRIANGLES, command.IB->GetCount(), GL_UNSIGNED_INT, nullptr));
+    }
+
+    m_Commands.clear();
+    m_Entries.clear();
+    m_ShaderIndices.clear();
+    m_TextureIndices.clear();
+}
+
+void RenderQueue::PrintStats() const
+{
+    const RenderStateChanges& a = m_Stats.Submitted;
+    const RenderStateChanges& b = m_Stats.Sorted;
+    std::cout << "[RenderQueue] " << m_Stats.CommandCount << " commands | "
+        << "shader " << a.Shaders << " -> " << b.Shaders << ", "
+        << "vao " << a.VertexArrays << " -> " << b.VertexArrays << ", "
+        << "ibo " << a.IndexBuffers << " -> " << b.IndexBuffers << ", "
+        << "texture " << a.Textures << " -> " << b.Textures << std::endl;
+}
+
+void RenderQueue::Sort()
+{
+    // LSD radix sort on the 64 bit key, one byte per pass. It's stable, so commands with equal keys keep submission order
+    if (m_Entries.size() < 2)
+        return;
+
+    m_Scratch.resize(m_Entries.size());
+    std::vector<SortEntry>* src = &m_Entries;
+    std::vector<SortEntry>* dst = &m_Scratch;
+
+    for (unsigned int shift = 0; shift < 64; shift += 8)
+    {
+        unsigned int counts[256] = {};
+        for (const SortEntry& entry : *src)
+            counts[(entry.Key >> shift) & 0xFF]++;
+
+        if (counts[((*src)[0].Key >> shift) & 0xFF] == src->size()) // Every key has the same byte here, nothing to do
+            continue;
+
+        unsigned int offsets[256];
+        unsigned int total = 0;
+        for (unsigned int i = 0; i < 256; i++)
+        {
+            offsets[i] = total;
+            total += counts[i];
+        }
+
+        for (const SortEntry& entry : *src)
+            (*dst)[offsets[(entry.Key >> shift) & 0xFF]++] = entry;
+
+        std::swap(src, dst);
+    }
+
+    if (src != &m_Entries)
+        m_Entries.swap(m_Scratch);
+}
+
+RenderStateChanges RenderQueue::CountStateChanges(const std::vector<SortEntry>& order) const
+{
+    RenderStateChanges changes;
+    const Shader* lastShader = nullptr;
+    const VertexArray* lastVA = nullptr;
+    const IndexBuffer* lastIB = nullptr;
+    const Texture* lastTextures[RenderCommand::MaxTextures] = {};
+
+    for (const SortEntry& entry : order)
+    {
+        const RenderCommand& command = m_Commands[entry.Index];
+        if (command.Program != lastShader) { changes.Shaders++; lastShader = command.Program; }
+        if (command.VA != lastVA) { changes.VertexArrays++; lastVA = command.VA; lastIB = nullptr; }
+        if (command.IB != lastIB) { changes.IndexBuffers++; lastIB = command.IB; }
+        for (unsigned int i = 0; i < command.TextureCount; i++)
+        {
+            if (command.Textures[i] != lastTextures[i]) { changes.Textures++; lastTextures[i] = command.Textures[i]; }
+        }
+    }
+    return changes;
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include "GLPrerequisites.h"
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "VertexArray.h"
+#include "IndexBuffer.h"
+#include "Shader.h"
+#include "Texture.h"
+
+#include "glm.hpp"
+
+struct RenderCommand
+{
+	static const unsigned int MaxTextures = 4;
+
+	Shader* Program;
+	const VertexArray* VA;
+	const IndexBuffer* IB;
+	const Texture* Textures[MaxTextures]; // Bound to units 0..TextureCount-1
+	unsigned int TextureCount;
+
+	glm::mat4 MVP; // Uploaded as "u_MVP"
+	glm::vec4 Color; // Uploaded as "u_Color" when HasColor is set
+	bool HasColor;
+
+	unsigned char Layer; // Lower layers are drawn first
+	bool Translucent; // Translucent commands go after opaque ones in the same layer and are sorted back to front
+	float Depth; // Normalised view depth, 0 = near, 1 = far
+};
+
+struct RenderStateChanges
+{
+	unsigned int Shaders = 0;
+	unsigned int VertexArrays = 0;
+	unsigned int IndexBuffers = 0;
+	unsigned int Textures = 0;
+};
+
+struct RenderQueueStats
+{
+	unsigned int CommandCount = 0;
+	RenderStateChanges Submitted; // What the frame would have cost in the order it was recorded
+	RenderStateChanges Sorted; // What it actually cost after sorting
+};
+
+class RenderQueue // Records a frame's draws, then sorts them so state changes are grouped
+{
+private:
+	struct SortEntry
+	{
+		uint64_t Key;
+		unsigned int Index;
+	};
+
+	std::vector<RenderCommand> m_Commands; // Frame local, cleared but never shrunk
+	std::vector<SortEntry> m_Entries;
+	std::vector<SortEntry> m_Scratch; // Ping-pong buffer for the radix sort
+	std::unordered_map<unsigned int, unsigned int> m_ShaderIndices; // GL name -> dense index in order of first use, frame local
+	std::unordered_map<unsigned int, unsigned int> m_TextureIndices;
+	RenderQueueStats m_Stats;
+public:
+	RenderQueue(unsigned int reserve = 1024);
+
+	void Submit(const RenderCommand& command);
+	void Execute(); // Sorts, issues every command and clears the queue for the next frame
+
+	inline const RenderQueueStats& GetStats() const { return m_Stats; }
+	void PrintStats() const;
+
+	static const unsigned int MaxSortIndex = 0xFFF; // Distinct shaders / textures a frame the key can tell apart, whatever their GL names
+
+	static uint64_t MakeSortKey(const RenderCommand& command, unsigned int shaderIndex, unsigned int textureIndex); // Dense indices, not GL names
+private:
+	static unsigned int DenseIndex(std::unordered_map<unsigned int, unsigned int>& indices, unsigned int name);
+
+	void Sort();
+	RenderStateChanges CountStateChanges(const std::vector<SortEntry>& order) const;
+};
@@ -1,6 +1,9 @@
 #include "Renderer.h"
 
+#include "CPUProfiler.h"
+
 #include <iostream>
+#include <atomic>
 
 void GLClearError()
 {
@@ -16,16 +19,209 @@ bool GLLogCall(const char* function, const char* file, int line)
     return true;
 }
 
+// Last call site seen by GLCall in debug mode, so the debug callback can say where it was
+static const char* s_CallFunction = "";
+static const char* s_CallFile = "";
+static int s_CallLine = 0;
+static bool s_DebugOutput = false;
+static bool s_DebugSynchronous = false;
+static std::atomic<bool> s_DebugError(false); // Set by the callback (maybe from a driver thread), picked up by GLEndCall
+
+void GLBeginCall(const char* function, const char* file, int line)
+{
+    s_CallFunction = function;
+    s_CallFile = file;
+    s_CallLine = line;
+
+    if (!s_DebugOutput)
+        GLClearError();
+}
+
+bool GLEndCall()
+{
+    if (!s_DebugOutput) // No KHR_debug, check the old way
+        return GLLogCall(s_CallFunction, s_CallFile, s_CallLine);
+
+    if (!s_DebugError.exchange(false))
+        return true;
+    if (s_DebugSynchronous)
+        return false; // The callback ran inside this call, so break here
+
+    // Asynchronous messages can arrive calls after the one that caused them, don't blame this one
+    static bool hinted = false;
+    if (!hinted)
+    {
+        std::cout << "    (asynchronous debug output, the failing call is unknown, run with --gl-sync to find it)" << std::endl;
+        hinted = true;
+    }
+    return true;
+}
+
+bool GLCheckErrors(const char* checkpoint)
+{
+    bool ok = true;
+    while (GLenum error = glGetError())
+    {
+        std::cout << "[OpenGL Error] (" << error << ") : somewhere before checkpoint '" << checkpoint << "'" << std::endl;
+        ok = false;
+    }
+    return ok;
+}
+
+static void GLAPIENTRY GLDebugCallback(GLenum source, GLenum type, GLuint id, GLenum severity, GLsizei length, const GLchar* message, const void* userParam)
+{
+    if (severity == GL_DEBUG_SEVERITY_NOTIFICATION)
+        return;
+
+    std::cout << "[OpenGL Debug] (" << id << ") : " << message << std::endl;
+    if (s_DebugSynchronous) // The call site is only meaningful when the callback runs inside the call
+        std::cout << "    at " << s_CallFunction << " " << s_CallFile << " : " << s_CallLine << std::endl;
+
+    if (type == GL_DEBUG_TYPE_ERROR)
+        s_DebugError = true;
+}
+
+bool GLEnableDebugOutput(bool synchronous)
+{
+    if (!GLEW_VERSION_4_3 && !GLEW_KHR_debug)
+    {
+        std::cout << "KHR_debug is not available, GLCall falls back to glGetError" << std::endl;
+        return false;
+    }
+
+    glEnable(GL_DEBUG_OUTPUT);
+    if (synchronous)
+        glEnable(GL_DEBUG_OUTPUT_SYNCHRONOUS);
+    else
+        glDisable(GL_DEBUG_OUTPUT_SYNCHRONOUS);
+    glDebugMessageCallback(GLDebugCallback, nullptr);
+
+    s_DebugOutput = true;
+    s_DebugSynchronous = synchronous;
+    return true;
+}
+
+void GLDisableDebugOutput()
+{
+    if (!s_DebugOutput)
+        return;
+
+    glDebugMessageCallback(nullptr, nullptr);
+    glDisable(GL_DEBUG_OUTPUT);
+    s_DebugOutput = false;
+    s_DebugSynchronous = false;
+}
+
+GPUProfileScope Renderer::Scope(const char* name) const
+{
+    return GPUProfileScope(m_Profiler, name);
+}
+
 void Renderer::Clear() const
 {
     GLCall(glClear(GL_COLOR_BUFFER_BIT));
 }
 
 void Renderer::Draw(const VertexArray& va, const IndexBuffer& ib, const Shader& shader) const
+{
+    Draw(va, ib, shader, ib.GetCount());
+}
+
+void Renderer::Draw(const VertexArray& va, const IndexBuffer& ib, const Shader& shader, unsigned int indexCount) const
+{
+    PROFILE_FUNCTION();
+    shader.Bind();
+    va.Bind();
+    ib.Bind();
+
+    GLCall(glDrawElements(GL_TRIANGLES, indexCount, GL_UNSIGNED_INT, nullptr)); // type could be unsigned short to optimise! make dynamic?
+}
+
+int Renderer::PushDrawBlock(const DrawBlock& drawData) const
+{
+    ASSERT(m_DrawData);
+    const unsigned int windowSize = sizeof(DrawBlock) * MaxDrawBlocks;
+    bool newWindow = m_DrawWindowCount == MaxDrawBlocks || m_DrawWindowFrame != m_DrawData->GetFrame();
+
+    // Binding a range per draw is slow on some drivers, so one range covers the next MaxDrawBlocks draws.
+    // The whole block has to lie inside the range, so a window only starts where a full one still fits
+    RingAllocation allocation;
+    if (!newWindow || m_DrawData->GetFree() >= windowSize)
+        allocation = m_DrawData->Push(drawData, newWindow ? 0 : 16); // Only a window start needs the bind offset alignment
+
+    if (!allocation.IsValid())
+    {
+        // Out of room this frame: each draw rewrites the only block of a plain uniform buffer instead,
+        // slower as the driver has to sync or copy on every update, but nothing goes missing
+        if (!m_DrawFallback)
+        {
+            std::cout << "Draw data ring is full (" << m_DrawData->GetSize() / RingBuffer::FramesInFlight
+                      << " bytes a frame), falling back to a uniform buffer update per draw. Make the ring bigger" << std::endl;
+            m_DrawFallback = std::make_unique<UniformBuffer>(windowSize, UniformBinding::Draw);
+        }
+        m_DrawFallback->SetData(&drawData, sizeof(DrawBlock));
+        m_DrawFallback->BindBase();
+        m_DrawWindowCount = MaxDrawBlocks; // The ring's window is no longer bound
+        return 0;
+    }
+
+    if (newWindow)
+    {
+        RingAllocation window;
+        window.Offset = allocation.Offset;
+        window.Size = windowSize;
+        m_DrawData->BindRange((unsigned int)UniformBinding::Draw, window);
+
+        m_DrawWindowOffset = allocation.Offset;
+        m_DrawWindowCount = 0;
+        m_DrawWindowFrame = m_DrawData->GetFrame();
+    }
+
+    m_DrawWindowCount++;
+    return (int)((allocation.Offset - m_DrawWindowOffset) / sizeof(DrawBlock));
+}
+
+void Renderer::Draw(const VertexArray& va, const IndexBuffer& ib, const Shader& shader, const DrawBlock& drawData) const
+{
+    int drawIndex = PushDrawBlock(drawData);
+
+    shader.Bind();
+    shader.SetUniform(shader.GetDrawIndexUniform(), drawIndex);
+
+    Draw(va, ib, shader, ib.GetCount());
+}
+
+void Renderer::Draw(const VertexArray& va, const IndexBuffer& ib, const ShaderPipeline& pipeline) const
+{
+    PROFILE_FUNCTION();
+    pipeline.Bind();
+    va.Bind();
+    ib.Bind();
+
+    GLCall(glDrawElements(GL_TRIANGLES, ib.GetCount(), GL_UNSIGNED_INT, nullptr));
+}
+
+void Renderer::Draw(const VertexArray& va, const IndexBuffer& ib, const ShaderPipeline& pipeline, const DrawBlock& drawData) const
+{
+    const Shader* vertex = pipeline.GetStage(ShaderStage::Vertex);
+    if (!vertex)
+    {
+        std::cout << "ShaderPipeline has no vertex stage to take u_DrawIndex, skipping the draw" << std::endl;
+        ASSERT(false);
+        return;
+    }
+
+    int drawIndex = PushDrawBlock(drawData);
+    vertex->SetUniform(vertex->GetDrawIndexUniform(), drawIndex); // Separable, so no bind needed
+
+    Draw(va, ib, pipeline);
+}
+
+void Renderer::DrawInstanced(const VertexArray& va, const IndexBuffer& ib, const Shader& shader, unsigned int instanceCount) const
 {
     shader.Bind();
     va.Bind();
     ib.Bind();
 
-    GLCall(glDrawElements(GL_TRIANGLES, ib.GetCount(), GL_UNSIGNED_INT, nullptr)); // type could be unsigned short to optimise! make dynamic?
+    GLCall(glDrawElementsInstanced(GL_TRIANGLES, ib.GetCount(), GL_UNSIGNED_INT, nullptr, instanceCount)); // Per-instance attributes come from buffers added with a divisor
 }
\ No newline at end of file
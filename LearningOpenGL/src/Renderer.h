@@ -5,21 +5,39 @@
 #include "VertexArray.h"
 #include "IndexBuffer.h"
 #include "Shader.h"
+#include "ShaderPipeline.h"
+#include "GPUProfiler.h"
+#include "RingBuffer.h"
+#include "UniformBuffer.h"
+#include "UniformBlocks.h"
 
-
-/*
-#define ASSERT(x) if (!(x)) __debugbreak();
-#define GLCall(x) GLClearError();\
-    x;\
-    ASSERT(GLLogCall(#x, __FILE__, __LINE__));
-
-void GLClearError();
-bool GLLogCall(const char* function, const char* file, int line);
-*/
+#include <memory>
 
 class Renderer // Debate over static or singleton?
 {
+private:
+    GPUProfiler* m_Profiler = nullptr; // Optional, scopes are free when there is none
+    RingBuffer* m_DrawData = nullptr; // Needed by the DrawBlock overload
+
+    // DrawBlocks are packed back to back and bound MaxDrawBlocks at a time, each draw only passes its index into the window
+    mutable unsigned int m_DrawWindowOffset = 0;
+    mutable unsigned int m_DrawWindowCount = MaxDrawBlocks; // Full, so the first draw starts a window
+    mutable unsigned int m_DrawWindowFrame = 0;
+    mutable std::unique_ptr<UniformBuffer> m_DrawFallback; // Takes one block per draw once the ring runs out for the frame, made on first use
+
+    int PushDrawBlock(const DrawBlock& drawData) const; // Index into the bound window for u_DrawIndex
 public:
     void Clear() const;
     void Draw(const VertexArray& va, const IndexBuffer& ib, const Shader& shader) const;
+    void Draw(const VertexArray& va, const IndexBuffer& ib, const Shader& shader, unsigned int indexCount) const; // Draws only the first 'indexCount' indices
+    void Draw(const VertexArray& va, const IndexBuffer& ib, const Shader& shader, const DrawBlock& drawData) const; // Streams drawData to the shader's "Draw" block, see Object.shader
+    void Draw(const VertexArray& va, const IndexBuffer& ib, const ShaderPipeline& pipeline) const;
+    void Draw(const VertexArray& va, const IndexBuffer& ib, const ShaderPipeline& pipeline, const DrawBlock& drawData) const; // u_DrawIndex is set on the vertex stage
+    void DrawInstanced(const VertexArray& va, const IndexBuffer& ib, const Shader& shader, unsigned int instanceCount) const;
+
+    inline void SetProfiler(GPUProfiler* profiler) { m_Profiler = profiler; }
+    inline GPUProfiler* GetProfiler() const { return m_Profiler; }
+    inline void SetDrawData(RingBuffer* drawData) { m_DrawData = drawData; }
+    inline RingBuffer* GetDrawData() const { return m_DrawData; }
+    GPUProfileScope Scope(const char* name) const; // auto scope = renderer.Scope("Sprites"); times until it goes out of scope
 };
\ No newline at end of file
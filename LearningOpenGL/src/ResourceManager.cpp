@@ -0,0 +1,313 @@
+#include "ResourceManager.h"
+
+#include "CPUProfiler.h"
+#include "Hash.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <thread>
+#include <unordered_set>
+
+static const unsigned int s_None = 0xFFFFFFFF;
+
+static uint64_t HashFile(const std::string& path) // FNV-1a of the bytes and the size, 0 if the file can't be read
+{
+	std::ifstream stream(path, std::ios::binary);
+	if (!stream)
+		return 0;
+
+	uint64_t hash = Hash::FNVOffsetBasis, size = 0;
+	char buffer[64 * 1024];
+	while (stream.read(buffer, sizeof(buffer)) || stream.gcount() > 0)
+	{
+		hash = Hash::FNV1a(buffer, (size_t)stream.gcount(), hash);
+		size += (uint64_t)stream.gcount();
+	}
+	hash = Hash::FNV1a(&size, sizeof(size), hash);
+	return hash == 0 ? 1 : hash; // 0 means unreadable
+}
+
+static bool SameFileContents(const std::string& a, const std::string& b) // Settles hash matches, 64 bits can still collide
+{
+	std::ifstream first(a, std::ios::binary | std::ios::ate), second(b, std::ios::binary | std::ios::ate);
+	if (!first || !second || first.tellg() != second.tellg())
+		return false;
+	first.seekg(0);
+	second.seekg(0);
+
+	char bufferA[64 * 1024], bufferB[64 * 1024];
+	while (first.read(bufferA, sizeof(bufferA)) || first.gcount() > 0)
+	{
+		std::streamsize count = first.gcount();
+		if (!second.read(bufferB, count) || std::memcmp(bufferA, bufferB, (size_t)count) != 0)
+			return false;
+	}
+	return true;
+}
+
+ResourceManager::ResourceManager(unsigned int threadCount)
+	: m_TextureLoader(4 * 1024 * 1024, threadCount), m_PlaceholderShader("res/shaders/Placeholder.shader"), m_ThreadCount(threadCount)
+{
+	if (m_ThreadCount == 0)
+		m_ThreadCount = std::max(std::thread::hardware_concurrency(), 2u) - 1; // Same as the TextureLoader
+}
+
+TextureRef ResourceManager::LoadTexture(const std::string& path)
+{
+	return std::move(LoadTextures({ path })[0]);
+}
+
+std::vector<TextureRef> ResourceManager::LoadTextures(const std::vector<std::string>& paths)
+{
+	PROFILE_FUNCTION();
+	std::vector<std::string> canonicalPaths(paths.size());
+	std::vector<unsigned int> unknown; // Not found by path, their bytes have to be hashed
+	std::unordered_set<std::string> seen;
+	for (unsigned int i = 0; i < paths.size(); i++)
+	{
+		canonicalPaths[i] = CanonicalPath(paths[i]);
+		if (m_TexturePaths.find(canonicalPaths[i]) == m_TexturePaths.end() && seen.insert(canonicalPaths[i]).second)
+			unknown.push_back(i);
+	}
+
+	std::vector<uint64_t> hashes(paths.size(), 0);
+	std::atomic<size_t> next(0);
+	auto work = [&]()
+	{
+		for (size_t job = next++; job < unknown.size(); job = next++)
+			hashes[unknown[job]] = HashFile(paths[unknown[job]]);
+	};
+	std::vector<std::thread> threads;
+	for (unsigned int i = 1; i < std::min<size_t>(m_ThreadCount, unknown.size()); i++)
+		threads.emplace_back(work);
+	work();
+	for (std::thread& thread : threads)
+		thread.join();
+
+	std::vector<TextureRef> textures;
+	textures.reserve(paths.size());
+	for (unsigned int i = 0; i < paths.size(); i++)
+	{
+		m_Stats.Requests++;
+		unsigned int index = FindTexture(canonicalPaths[i], hashes[i]);
+		if (index == s_None)
+			index = AddTexture(canonicalPaths[i], paths[i], hashes[i]);
+		textures.push_back(TextureRef(this, index));
+	}
+	return textures;
+}
+
+ShaderRef ResourceManager::LoadShader(const std::string& path, const std::vector<std::string>& defines)
+{
+	m_Stats.Requests++;
+	std::vector<std::string> sortedDefines = defines; // { "A", "B" } and { "B", "A", "A" } build the same program
+	std::sort(sortedDefines.begin(), sortedDefines.end());
+	sortedDefines.erase(std::unique(sortedDefines.begin(), sortedDefines.end()), sortedDefines.end());
+
+	std::string key = CanonicalPath(path);
+	for (const std::string& define : sortedDefines)
+		key += "\n" + define;
+
+	auto it = m_ShaderKeys.find(key);
+	if (it != m_ShaderKeys.end())
+	{
+		m_Stats.PathHits++;
+		return ShaderRef(this, it->second);
+	}
+
+	unsigned int index;
+	if (m_FreeShaders.empty())
+	{
+		index = (unsigned int)m_Shaders.size();
+		m_Shaders.emplace_back();
+	}
+	else
+	{
+		index = m_FreeShaders.back();
+		m_FreeShaders.pop_back();
+	}
+
+	ShaderEntry& entry = m_Shaders[index];
+	entry.Key = key;
+	entry.Loading = m_ShaderCompiler.Submit(path, sortedDefines);
+	m_ShaderKeys[key] = index;
+	m_Stats.Loaded++;
+	return ShaderRef(this, index);
+}
+
+unsigned int ResourceManager::Poll()
+{
+	PROFILE_FUNCTION();
+	unsigned int pending = m_ShaderCompiler.Poll() + m_TextureLoader.Poll();
+	for (unsigned int i = 0; i < m_Textures.size(); i++)
+	{
+		TextureEntry& entry = m_Textures[i];
+		if (!entry.Loading.IsValid() || m_TextureLoader.GetStatus(entry.Loading) == TextureStatus::Pending)
+			continue;
+
+		entry.Resource = m_TextureLoader.Take(entry.Loading); // Stays nullptr if it failed, Get gives the placeholder
+		entry.Loading = TextureHandle();
+		if (entry.References == 0) // Released while it was loading
+			UnloadTexture(i);
+	}
+	for (unsigned int i = 0; i < m_Shaders.size(); i++)
+	{
+		ShaderEntry& entry = m_Shaders[i];
+		if (!entry.Loading.IsValid() || m_ShaderCompiler.GetStatus(entry.Loading) == ShaderStatus::Pending)
+			continue;
+
+		entry.Resource = m_ShaderCompiler.Take(entry.Loading);
+		entry.Loading = ShaderHandle();
+		if (entry.References == 0)
+			UnloadShader(i);
+	}
+	return pending;
+}
+
+void ResourceManager::WaitAll()
+{
+	while (Poll() > 0)
+		std::this_thread::yield();
+}
+
+const Texture& ResourceManager::Get(const TextureRef& texture) const
+{
+	if (!IsLoaded(texture))
+		return m_TextureLoader.Get(TextureHandle());
+	return *m_Textures[texture.m_Index].Resource;
+}
+
+const Shader& ResourceManager::Get(const ShaderRef& shader) const
+{
+	if (!IsLoaded(shader))
+		return m_PlaceholderShader;
+	return *m_Shaders[shader.m_Index].Resource;
+}
+
+bool ResourceManager::IsLoaded(const TextureRef& texture) const
+{
+	return texture.m_Manager == this && m_Textures[texture.m_Index].Resource != nullptr;
+}
+
+bool ResourceManager::IsLoaded(const ShaderRef& shader) const
+{
+	return shader.m_Manager == this && m_Shaders[shader.m_Index].Resource != nullptr;
+}
+
+std::string ResourceManager::CanonicalPath(const std::string& path)
+{
+	std::string result = path;
+#ifdef _WIN32
+	char buffer[_MAX_PATH];
+	if (_fullpath(buffer, path.c_str(), _MAX_PATH))
+		result = buffer;
+	std::transform(result.begin(), result.end(), result.begin(), [](char c) { return (char)std::tolower((unsigned char)c); }); // NTFS ignores case
+#else
+	if (char* resolved = realpath(path.c_str(), nullptr))
+	{
+		result = resolved;
+		std::free(resolved);
+	}
+#endif
+	std::replace(result.begin(), result.end(), '\\', '/');
+	return result;
+}
+
+void ResourceManager::AddReference(ResourceType type, unsigned int index)
+{
+	if (type == ResourceType::Texture)
+		m_Textures[index].References++;
+	else
+		m_Shaders[index].References++;
+}
+
+void ResourceManager::RemoveReference(ResourceType type, unsigned int index)
+{
+	if (type == ResourceType::Texture)
+	{
+		TextureEntry& entry = m_Textures[index];
+		ASSERT(entry.References > 0);
+		if (--entry.References == 0 && !entry.Loading.IsValid()) // Still loading ones go in Poll, the loader can't be stopped halfway
+			UnloadTexture(index);
+	}
+	else
+	{
+		ShaderEntry& entry = m_Shaders[index];
+		ASSERT(entry.References > 0);
+		if (--entry.References == 0 && !entry.Loading.IsValid())
+			UnloadShader(index);
+	}
+}
+
+unsigned int ResourceManager::FindTexture(const std::string& canonicalPath, uint64_t hash)
+{
+	auto path = m_TexturePaths.find(canonicalPath);
+	if (path != m_TexturePaths.end())
+	{
+		m_Stats.PathHits++;
+		return path->second;
+	}
+
+	auto content = hash != 0 ? m_TextureHashes.find(hash) : m_TextureHashes.end();
+	if (content != m_TextureHashes.end() && SameFileContents(canonicalPath, m_Textures[content->second].Paths[0]))
+	{
+		m_Stats.ContentHits++;
+		m_Textures[content->second].Paths.push_back(canonicalPath); // Found by path from now on
+		m_TexturePaths[canonicalPath] = content->second;
+		return content->second;
+	}
+	return s_None;
+}
+
+unsigned int ResourceManager::AddTexture(const std::string& canonicalPath, const std::string& path, uint64_t hash)
+{
+	unsigned int index;
+	if (m_FreeTextures.empty())
+	{
+		index = (unsigned int)m_Textures.size();
+		m_Textures.emplace_back();
+	}
+	else
+	{
+		index = m_FreeTextures.back();
+		m_FreeTextures.pop_back();
+	}
+
+	TextureEntry& entry = m_Textures[index];
+	entry.Paths.push_back(canonicalPath);
+	entry.Hash = hash;
+	entry.Loading = m_TextureLoader.Submit(path); // Read again by the decode thread, the OS has it cached from hashing by then
+	m_TexturePaths[canonicalPath] = index;
+	if (hash != 0)
+		m_TextureHashes.emplace(hash, index); // On a collision the first file keeps the hash, this one is only found by path
+	m_Stats.Loaded++;
+	return index;
+}
+
+void ResourceManager::UnloadTexture(unsigned int index)
+{
+	TextureEntry& entry = m_Textures[index];
+	for (const std::string& path : entry.Paths)
+		m_TexturePaths.erase(path);
+	auto content = m_TextureHashes.find(entry.Hash);
+	if (content != m_TextureHashes.end() && content->second == index)
+		m_TextureHashes.erase(content);
+
+	entry = TextureEntry(); // Deletes the Texture
+	m_FreeTextures.push_back(index);
+	m_Stats.Unloaded++;
+}
+
+void ResourceManager::UnloadShader(unsigned int index)
+{
+	ShaderEntry& entry = m_Shaders[index];
+	m_ShaderKeys.erase(entry.Key);
+
+	entry = ShaderEntry();
+	m_FreeShaders.push_back(index);
+	m_Stats.Unloaded++;
+}
@@ -0,0 +1,190 @@
+#pragma once
+
+#include "GLPrerequisites.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "Shader.h"
+#include "ShaderCompiler.h"
+#include "Texture.h"
+#include "TextureLoader.h"
+
+class ResourceManager;
+
+enum class ResourceType
+{
+	Texture, Shader
+};
+
+/*
+Counted reference to something a ResourceManager loaded, the size of a pointer and an index. Copies add
+a reference, destroying the last one unloads it. Default constructed refs are invalid.
+*/
+template<ResourceType Type>
+class ResourceRef
+{
+private:
+	ResourceManager* m_Manager;
+	unsigned int m_Index;
+
+	ResourceRef(ResourceManager* manager, unsigned int index); // Adds the reference, only the manager makes these
+	friend class ResourceManager;
+public:
+	ResourceRef() : m_Manager(nullptr), m_Index(0xFFFFFFFF) {}
+	ResourceRef(const ResourceRef& other);
+	ResourceRef(ResourceRef&& other);
+	~ResourceRef();
+
+	ResourceRef& operator=(ResourceRef other); // By value, so both copy and move assignment swap through here
+	bool operator==(const ResourceRef& other) const { return m_Manager == other.m_Manager && m_Index == other.m_Index; }
+	bool operator!=(const ResourceRef& other) const { return !(*this == other); }
+
+	void Release(); // Same as destroying it, the ref is invalid afterwards
+	inline bool IsValid() const { return m_Manager != nullptr; }
+};
+
+using TextureRef = ResourceRef<ResourceType::Texture>;
+using ShaderRef = ResourceRef<ResourceType::Shader>;
+
+struct ResourceStats
+{
+	unsigned int Requests = 0;
+	unsigned int PathHits = 0; // Requests for something already loaded or loading, by canonical path
+	unsigned int ContentHits = 0; // Textures at a new path whose file bytes matched one already loaded
+	unsigned int Loaded = 0;
+	unsigned int Unloaded = 0;
+};
+
+/*
+Loads every texture and shader once, however many places ask for it. Textures are found again by their
+canonical path (relative, "./" and "..\\" spellings of one file all match) and then by a hash of the
+file's bytes, confirmed by comparing the files, so a copy of an image under another name shares the
+first one's Texture too. Shaders are
+matched by canonical path and the set of defines, in any order.
+
+Loading goes through a TextureLoader (decoded on worker threads, uploaded in budgeted bands) and a
+ShaderCompiler (parallel compiles where the driver allows), Poll once a frame moves it all along.
+LoadTextures reads and hashes a whole list of files on worker threads before handing the new ones over.
+
+    ResourceManager resources;
+    TextureRef gojo = resources.LoadTexture("res/textures/GojoTexture256x256.png");
+    TextureRef same = resources.LoadTexture("./res/textures/../textures/GojoTexture256x256.png"); // gojo == same
+    while (resources.Poll() > 0) {}
+    resources.Get(gojo).Bind(0);
+
+The manager must outlive every ref it handed out. Something released while still loading is dropped as
+soon as the load finishes.
+*/
+class ResourceManager
+{
+private:
+	struct TextureEntry
+	{
+		std::vector<std::string> Paths; // Canonical paths that found this entry, content duplicates add theirs
+		uint64_t Hash = 0; // Of the file's bytes, 0 if it couldn't be read
+		TextureHandle Loading; // Valid until the TextureLoader is done with it
+		std::unique_ptr<Texture> Resource; // nullptr while loading or if loading failed
+		unsigned int References = 0;
+	};
+
+	struct ShaderEntry
+	{
+		std::string Key; // Canonical path and defines
+		ShaderHandle Loading;
+		std::unique_ptr<Shader> Resource;
+		unsigned int References = 0;
+	};
+
+	TextureLoader m_TextureLoader;
+	ShaderCompiler m_ShaderCompiler;
+	Shader m_PlaceholderShader; // res/shaders/Placeholder.shader, handed out for shaders that aren't linked
+	std::vector<TextureEntry> m_Textures; // Indexed by TextureRef, entries with no Paths are free
+	std::vector<ShaderEntry> m_Shaders; // Indexed by ShaderRef, entries with an empty Key are free
+	std::vector<unsigned int> m_FreeTextures;
+	std::vector<unsigned int> m_FreeShaders;
+	std::unordered_map<std::string, unsigned int> m_TexturePaths;
+	std::unordered_map<uint64_t, unsigned int> m_TextureHashes;
+	std::unordered_map<std::string, unsigned int> m_ShaderKeys;
+	unsigned int m_ThreadCount;
+	ResourceStats m_Stats;
+public:
+	ResourceManager(unsigned int threadCount = 0); // Decode and hashing threads, 0 uses all but one hardware thread
+
+	TextureRef LoadTexture(const std::string& path);
+	std::vector<TextureRef> LoadTextures(const std::vector<std::string>& paths); // Same order as 'paths'
+	ShaderRef LoadShader(const std::string& path, const std::vector<std::string>& defines = {});
+
+	unsigned int Poll(); // Returns how many textures and shaders are still loading
+	void WaitAll();
+
+	const Texture& Get(const TextureRef& texture) const; // The TextureLoader's grey placeholder until loaded, or if loading failed
+	const Shader& Get(const ShaderRef& shader) const; // A magenta placeholder until linked, or if linking failed
+	bool IsLoaded(const TextureRef& texture) const;
+	bool IsLoaded(const ShaderRef& shader) const;
+
+	inline unsigned int GetTextureCount() const { return (unsigned int)(m_Textures.size() - m_FreeTextures.size()); }
+	inline unsigned int GetShaderCount() const { return (unsigned int)(m_Shaders.size() - m_FreeShaders.size()); }
+	inline const ResourceStats& GetStats() const { return m_Stats; }
+
+	static std::string CanonicalPath(const std::string& path); // Absolute, symlinks and ".." resolved, '/' separated. Lower case on Windows
+private:
+	template<ResourceType Type> friend class ResourceRef;
+	void AddReference(ResourceType type, unsigned int index);
+	void RemoveReference(ResourceType type, unsigned int index);
+
+	unsigned int FindTexture(const std::string& canonicalPath, uint64_t hash); // Index of a match, 0xFFFFFFFF for none
+	unsigned int AddTexture(const std::string& canonicalPath, const std::string& path, uint64_t hash); // Starts the load
+	void UnloadTexture(unsigned int index);
+	void UnloadShader(unsigned int index);
+};
+
+template<ResourceType Type>
+ResourceRef<Type>::ResourceRef(ResourceManager* manager, unsigned int index)
+	: m_Manager(manager), m_Index(index)
+{
+	m_Manager->AddReference(Type, m_Index);
+}
+
+template<ResourceType Type>
+ResourceRef<Type>::ResourceRef(const ResourceRef& other)
+	: m_Manager(other.m_Manager), m_Index(other.m_Index)
+{
+	if (m_Manager)
+		m_Manager->AddReference(Type, m_Index);
+}
+
+template<ResourceType Type>
+ResourceRef<Type>::ResourceRef(ResourceRef&& other)
+	: m_Manager(other.m_Manager), m_Index(other.m_Index)
+{
+	other.m_Manager = nullptr;
+	other.m_Index = 0xFFFFFFFF;
+}
+
+template<ResourceType Type>
+ResourceRef<Type>::~ResourceRef()
+{
+	Release();
+}
+
+template<ResourceType Type>
+ResourceRef<Type>& ResourceRef<Type>::operator=(ResourceRef other)
+{
+	std::swap(m_Manager, other.m_Manager);
+	std::swap(m_Index, other.m_Index);
+	return *this; // 'other' takes the old reference with it
+}
+
+template<ResourceType Type>
+void ResourceRef<Type>::Release()
+{
+	if (m_Manager)
+		m_Manager->RemoveReference(Type, m_Index);
+	m_Manager = nullptr;
+	m_Index = 0xFFFFFFFF;
+}
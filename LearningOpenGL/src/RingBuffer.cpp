@@ -0,0 +1,135 @@
+#include "RingBuffer.h"
+
+#include "GLState.h"
+
+#include <cstring>
+#include <iostream>
+
+static const GLuint64 s_FenceTimeout = 1000000000; // 1 second, in nanoseconds
+
+RingBuffer::RingBuffer(unsigned int target, unsigned int bytesPerFrame)
+    : m_RendererID(0), m_Target(target), m_Alignment(256), m_SegmentSize(0), m_Segment(0), m_Frame(0), m_Head(0), m_Mapped(nullptr), m_Fences()
+{
+    int alignment = 0;
+    GLCall(glGetIntegerv(target == GL_SHADER_STORAGE_BUFFER ? GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT : GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment));
+    if (alignment > 0)
+        m_Alignment = (unsigned int)alignment;
+    m_SegmentSize = (bytesPerFrame + m_Alignment - 1) / m_Alignment * m_Alignment;
+    unsigned int size = m_SegmentSize * FramesInFlight;
+
+    GLCall(glGenBuffers(1, &m_RendererID));
+    GLState::BindBuffer(target, m_RendererID);
+    if (GLEW_VERSION_4_4 || GLEW_ARB_buffer_storage)
+    {
+        GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT; // Coherent, so writes are visible to the next draw without a flush
+        GLCall(glBufferStorage(target, size, nullptr, flags));
+        GLCall(m_Mapped = (unsigned char*)glMapBufferRange(target, 0, size, flags));
+    }
+    else
+    {
+        GLCall(glBufferData(target, size, nullptr, GL_STREAM_DRAW));
+    }
+
+    m_Segment = FramesInFlight - 1; // The first BeginFrame moves to segment 0
+}
+
+RingBuffer::~RingBuffer()
+{
+    for (GLsync fence : m_Fences)
+    {
+        if (fence)
+        {
+            GLCall(glDeleteSync(fence));
+        }
+    }
+
+    if (m_Mapped)
+    {
+        GLState::BindBuffer(m_Target, m_RendererID);
+        GLCall(glUnmapBuffer(m_Target));
+    }
+    GLCall(glDeleteBuffers(1, &m_RendererID));
+    GLState::OnBufferDeleted(m_RendererID);
+}
+
+void RingBuffer::BeginFrame()
+{
+    m_Segment = (m_Segment + 1) % FramesInFlight;
+    m_Frame++;
+    m_Head = 0;
+    m_Stats.Allocations = 0;
+    m_Stats.BytesUsed = 0;
+    m_Stats.Overflows = 0;
+
+    GLsync& fence = m_Fences[m_Segment];
+    if (!fence)
+        return;
+
+    GLenum result = glClientWaitSync(fence, 0, 0); // Usually signalled long ago
+    if (result == GL_TIMEOUT_EXPIRED)
+    {
+        m_Stats.Stalls++;
+        do
+            result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, s_FenceTimeout);
+        while (result == GL_TIMEOUT_EXPIRED);
+    }
+    ASSERT(result != GL_WAIT_FAILED);
+
+    GLCall(glDeleteSync(fence));
+    fence = nullptr;
+}
+
+void RingBuffer::EndFrame()
+{
+    GLsync& fence = m_Fences[m_Segment];
+    if (fence)
+    {
+        GLCall(glDeleteSync(fence));
+    }
+    GLCall(fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0));
+}
+
+RingAllocation RingBuffer::Allocate(const void* data, unsigned int size, unsigned int alignment)
+{
+    if (alignment == 0)
+        alignment = m_Alignment;
+    unsigned int start = (m_Head + alignment - 1) / alignment * alignment;
+
+    RingAllocation allocation;
+    if (start + size > m_SegmentSize)
+    {
+        if (m_Stats.Overflows++ == 0)
+            std::cout << "RingBuffer segment full (" << m_SegmentSize << " bytes), dropping per-draw data this frame" << std::endl;
+        return allocation;
+    }
+
+    allocation.Offset = m_Segment * m_SegmentSize + start;
+    allocation.Size = size;
+    if (m_Mapped)
+    {
+        std::memcpy(m_Mapped + allocation.Offset, data, size);
+    }
+    else
+    {
+        GLState::BindBuffer(m_Target, m_RendererID);
+        GLCall(glBufferSubData(m_Target, allocation.Offset, size, data));
+    }
+
+    m_Head = start + size;
+    m_Stats.Allocations++;
+    m_Stats.BytesUsed = m_Head;
+    return allocation;
+}
+
+unsigned int RingBuffer::GetFree(unsigned int alignment) const
+{
+    if (alignment == 0)
+        alignment = m_Alignment;
+    unsigned int start = (m_Head + alignment - 1) / alignment * alignment;
+    return start < m_SegmentSize ? m_SegmentSize - start : 0;
+}
+
+void RingBuffer::BindRange(unsigned int binding, const RingAllocation& allocation) const
+{
+    GLState::BindBufferRange(m_Target, binding, m_RendererID, allocation.Offset, allocation.Size);
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include "GLPrerequisites.h"
+
+struct RingAllocation
+{
+	unsigned int Offset = 0; // Bytes from the start of the buffer, aligned for glBindBufferRange
+	unsigned int Size = 0; // 0 if the frame's segment was full
+
+	inline bool IsValid() const { return Size != 0; }
+};
+
+struct RingBufferStats
+{
+	unsigned int Allocations = 0; // This frame
+	unsigned int BytesUsed = 0;
+	unsigned int Overflows = 0;
+	unsigned int Stalls = 0; // Frames that had to wait for the GPU before reusing a segment, since creation
+};
+
+/*
+Streams small blocks of per-draw data (DrawBlock etc.) to the GPU. The buffer is split into
+FramesInFlight segments, each frame writes its blocks one after another into its own segment and
+draws bind them with glBindBufferRange, so there are no per-value glUniform calls and nothing the GPU is
+still reading gets overwritten. A fence at EndFrame guards each segment until the GPU is done.
+
+With GL 4.4 / ARB_buffer_storage the buffer stays persistently mapped and Allocate is a memcpy. Without it
+each Allocate is a glBufferSubData into a range the fence already knows is free.
+*/
+class RingBuffer
+{
+public:
+	static const unsigned int FramesInFlight = 3;
+private:
+	unsigned int m_RendererID;
+	unsigned int m_Target; // GL_UNIFORM_BUFFER or GL_SHADER_STORAGE_BUFFER, or GL_PIXEL_UNPACK_BUFFER for TextureLoader
+	unsigned int m_Alignment; // GL_*_BUFFER_OFFSET_ALIGNMENT
+	unsigned int m_SegmentSize;
+	unsigned int m_Segment;
+	unsigned int m_Frame; // Counts BeginFrame calls
+	unsigned int m_Head; // Next free byte in the current segment
+	unsigned char* m_Mapped; // Persistent mapping, nullptr on the fallback path
+	GLsync m_Fences[FramesInFlight];
+	RingBufferStats m_Stats;
+public:
+	RingBuffer(unsigned int target, unsigned int bytesPerFrame);
+	~RingBuffer();
+
+	void BeginFrame(); // Moves to the next segment, waiting for the GPU only if it is still reading it
+	void EndFrame();
+
+	RingAllocation Allocate(const void* data, unsigned int size, unsigned int alignment = 0); // 0 aligns for BindRange, pass 16 to pack std140 array elements
+	template<typename T>
+	RingAllocation Push(const T& block, unsigned int alignment = 0) { return Allocate(&block, sizeof(T), alignment); }
+
+	unsigned int GetFree(unsigned int alignment = 0) const; // Bytes an Allocate with this alignment could still take this frame
+
+	void BindRange(unsigned int binding, const RingAllocation& allocation) const;
+
+	inline unsigned int GetRendererID() const { return m_RendererID; }
+	inline unsigned int GetSize() const { return m_SegmentSize * FramesInFlight; }
+	inline unsigned int GetFrame() const { return m_Frame; }
+	inline bool IsPersistent() const { return m_Mapped != nullptr; }
+	inline const RingBufferStats& GetStats() const { return m_Stats; }
+};
@@ -0,0 +1,87 @@
+#include "Sampler.h"
+
+#include "GLState.h"
+#include "Hash.h"
+
+#include <algorithm>
+#include <cstring>
+
+bool SamplerSettings::operator==(const SamplerSettings& other) const
+{
+	return MinFilter == other.MinFilter && MagFilter == other.MagFilter && WrapS == other.WrapS && WrapT == other.WrapT && WrapR == other.WrapR
+		&& Anisotropy == other.Anisotropy && LodBias == other.LodBias;
+}
+
+Sampler::Sampler(const SamplerSettings& settings)
+	: m_RendererID(0), m_Settings(settings)
+{
+	GLCall(glGenSamplers(1, &m_RendererID)); // Sampler parameters are set by name, no bind needed
+	GLCall(glSamplerParameteri(m_RendererID, GL_TEXTURE_MIN_FILTER, settings.MinFilter));
+	GLCall(glSamplerParameteri(m_RendererID, GL_TEXTURE_MAG_FILTER, settings.MagFilter));
+	GLCall(glSamplerParameteri(m_RendererID, GL_TEXTURE_WRAP_S, settings.WrapS));
+	GLCall(glSamplerParameteri(m_RendererID, GL_TEXTURE_WRAP_T, settings.WrapT));
+	GLCall(glSamplerParameteri(m_RendererID, GL_TEXTURE_WRAP_R, settings.WrapR));
+	GLCall(glSamplerParameterf(m_RendererID, GL_TEXTURE_LOD_BIAS, settings.LodBias));
+
+	float anisotropy = std::min(settings.Anisotropy, GetMaxAnisotropy());
+	if (anisotropy > 1.0f)
+	{
+		GLCall(glSamplerParameterf(m_RendererID, GL_TEXTURE_MAX_ANISOTROPY_EXT, anisotropy)); // Same enum as the GL 4.6 core one
+	}
+}
+
+Sampler::~Sampler()
+{
+	GLCall(glDeleteSamplers(1, &m_RendererID));
+	GLState::OnSamplerDeleted(m_RendererID);
+}
+
+void Sampler::Bind(unsigned int slot) const
+{
+	GLState::BindSampler(slot, m_RendererID);
+}
+
+void Sampler::Unbind(unsigned int slot) const
+{
+	GLState::BindSampler(slot, 0);
+}
+
+float Sampler::GetMaxAnisotropy()
+{
+	static float s_MaxAnisotropy = 0.0f; // Per context really, there is only ever one
+	if (s_MaxAnisotropy == 0.0f)
+	{
+		s_MaxAnisotropy = 1.0f;
+		if (GLEW_VERSION_4_6 || GLEW_ARB_texture_filter_anisotropic || GLEW_EXT_texture_filter_anisotropic)
+		{
+			GLCall(glGetFloatv(GL_MAX_TEXTURE_MAX_ANISOTROPY_EXT, &s_MaxAnisotropy));
+		}
+	}
+	return s_MaxAnisotropy;
+}
+
+size_t SamplerCache::SettingsHash::operator()(const SamplerSettings& settings) const
+{
+	unsigned int words[7] = { settings.MinFilter, settings.MagFilter, settings.WrapS, settings.WrapT, settings.WrapR };
+	std::memcpy(&words[5], &settings.Anisotropy, 4);
+	std::memcpy(&words[6], &settings.LodBias, 4);
+
+	return Hash::Fold(Hash::FNV1a(words, sizeof(words)));
+}
+
+const Sampler& SamplerCache::Get(const SamplerSettings& settings)
+{
+	auto it = m_Samplers.find(settings);
+	if (it != m_Samplers.end())
+		return *it->second;
+
+	std::unique_ptr<Sampler> sampler = std::make_unique<Sampler>(settings);
+	const Sampler& result = *sampler;
+	m_Samplers.emplace(settings, std::move(sampler));
+	return result;
+}
+
+void SamplerCache::Clear()
+{
+	m_Samplers.clear();
+}
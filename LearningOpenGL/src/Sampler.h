@@ -0,0 +1,76 @@
+#pragma once
+
+#include "GLPrerequisites.h"
+
+#include <cstddef>
+#include <memory>
+#include <unordered_map>
+
+struct SamplerSettings
+{
+	unsigned int MinFilter = GL_LINEAR_MIPMAP_LINEAR; // Trilinear, needs mips (Texture::GenerateMipmaps) or the texture samples as incomplete
+	unsigned int MagFilter = GL_LINEAR;
+	unsigned int WrapS = GL_CLAMP_TO_EDGE;
+	unsigned int WrapT = GL_CLAMP_TO_EDGE;
+	unsigned int WrapR = GL_CLAMP_TO_EDGE;
+	float Anisotropy = 1.0f; // Up to Sampler::GetMaxAnisotropy, 1 is off
+	float LodBias = 0.0f;
+
+	bool operator==(const SamplerSettings& other) const;
+};
+
+/*
+Sampler object (GL 3.3), filtering and wrapping kept apart from the texture. Bound to a unit it overrides
+the parameters of whatever texture is on that unit, so one sampler serves every texture drawn with the
+same settings and nothing has to be set per texture:
+
+    Sampler trilinear; // Defaults, trilinear and clamped
+    trilinear.Bind(0);
+    gojo.Bind(0);
+
+Binds go through GLState, binding the sampler a unit already has costs nothing.
+*/
+class Sampler
+{
+private:
+	unsigned int m_RendererID;
+	SamplerSettings m_Settings;
+public:
+	Sampler(const SamplerSettings& settings = SamplerSettings());
+	~Sampler();
+
+	void Bind(unsigned int slot) const;
+	void Unbind(unsigned int slot) const; // Back to the texture's own parameters
+
+	inline unsigned int GetRendererID() const { return m_RendererID; }
+	inline const SamplerSettings& GetSettings() const { return m_Settings; }
+
+	static float GetMaxAnisotropy(); // 1 without GL 4.6 or the anisotropic filtering extension
+};
+
+/*
+Shared samplers by their settings, asking twice for the same settings gives the same sampler. A handful
+cover a whole scene (trilinear clamped, trilinear repeating, nearest for pixel art) however many
+textures there are.
+
+    SamplerCache samplers;
+    SamplerSettings tiled;
+    tiled.WrapS = tiled.WrapT = GL_REPEAT;
+    tiled.Anisotropy = 8.0f;
+    samplers.Get(tiled).Bind(1);
+*/
+class SamplerCache
+{
+private:
+	struct SettingsHash
+	{
+		size_t operator()(const SamplerSettings& settings) const;
+	};
+
+	std::unordered_map<SamplerSettings, std::unique_ptr<Sampler>, SettingsHash> m_Samplers;
+public:
+	const Sampler& Get(const SamplerSettings& settings);
+	void Clear();
+
+	inline unsigned int GetCount() const { return (unsigned int)m_Samplers.size(); }
+};
@@ -1,139 +1,652 @@
 #include "Shader.h"
 
+#include "CPUProfiler.h"
+#include "GLState.h"
+#include "ShaderCache.h"
+#include "ShaderPreprocessor.h"
+#include "ShaderSpirv.h"
+#include "UniformBlocks.h"
+
+#include <chrono>
+#include <cstring>
 #include <iostream>
-#include <fstream>
 #include <string>
-#include <sstream>
+#include <vector>
 
 Shader::Shader(const std::string& filepath)
-	:m_FilePath(filepath), m_RendererID(0)
+	:m_FilePath(filepath), m_RendererID(0), m_Separable(false)
+{
+    SpirvProgram spirv = ShaderSpirv::Load(filepath); // Only when enabled and built for this file
+    if (spirv.Program != 0)
+    {
+        m_RendererID = spirv.Program;
+        SetUniforms(spirv.Uniforms);
+        return;
+    }
+    Build(ParseShader(filepath));
+}
+
+Shader::Shader(const std::string& name, const ShaderProgramSource& source)
+	:m_FilePath(name), m_RendererID(0), m_Separable(false)
+{
+    Build(source);
+}
+
+Shader::Shader(const std::string& name, const ShaderProgramSource& source, ShaderStage stage)
+	:m_FilePath(name + ":" + GetStageName(stage)), m_RendererID(0), m_Separable(true)
+{
+    if (!GLEW_VERSION_4_1 && !GLEW_ARB_separate_shader_objects)
+    {
+        std::cout << "'" << m_FilePath << "' needs separable programs (GL 4.1 or ARB_separate_shader_objects), which this GL context does not support!" << std::endl;
+        return;
+    }
+    if (!source.Has(stage))
+    {
+        std::cout << "'" << name << "' has no " << GetStageName(stage) << " shader!" << std::endl;
+        return;
+    }
+
+    ShaderProgramSource stageSource; // The other stages would be linked in too, and hash into the cache entry
+    stageSource.Stages[(unsigned int)stage] = source.Get(stage);
+    stageSource.Files = source.Files;
+    Build(stageSource);
+}
+
+Shader::Shader(const std::string& filepath, unsigned int program)
+	:m_FilePath(filepath), m_RendererID(program), m_Separable(false)
 {
-    ShaderProgramSource source = ParseShader(filepath);
-    m_RendererID = CreateShader(source.VertexSource, source.FragmentSource);
+    ReflectUniforms();
+}
+
+Shader::Shader(const std::string& filepath, unsigned int program, const std::vector<UniformInfo>& uniforms)
+	:m_FilePath(filepath), m_RendererID(program), m_Separable(false)
+{
+    SetUniforms(uniforms);
 }
 
 Shader::~Shader()
 {
     GLCall(glDeleteProgram(m_RendererID));
+    GLState::OnProgramDeleted(m_RendererID);
+}
+
+static const char* s_StageNames[] = { "vertex", "tess_control", "tess_evaluation", "geometry", "fragment", "compute" };
+static const unsigned int s_StageTypes[] = { GL_VERTEX_SHADER, GL_TESS_CONTROL_SHADER, GL_TESS_EVALUATION_SHADER, GL_GEOMETRY_SHADER, GL_FRAGMENT_SHADER, GL_COMPUTE_SHADER };
+
+struct SourceView // Part of the file buffer, C++14 has no std::string_view
+{
+    const char* Data = nullptr;
+    size_t Size = 0;
+    unsigned int FirstLine = 0;
+};
+
+static bool StartsWith(const char* begin, const char* end, const char* prefix, size_t length)
+{
+    return (size_t)(end - begin) >= length && std::memcmp(begin, prefix, length) == 0;
+}
+
+static const char* SkipSpaces(const char* begin, const char* end)
+{
+    while (begin < end && (*begin == ' ' || *begin == '\t'))
+        begin++;
+    return begin;
+}
+
+static int FindStage(const char* begin, const char* end) // The word after "#shader"
+{
+    begin = SkipSpaces(begin, end);
+    const char* wordEnd = begin;
+    while (wordEnd < end && *wordEnd != ' ' && *wordEnd != '\t' && *wordEnd != '\r' && *wordEnd != '\n')
+        wordEnd++;
+
+    for (unsigned int i = 0; i < (unsigned int)ShaderStage::Count; i++)
+    {
+        size_t length = std::strlen(s_StageNames[i]);
+        if ((size_t)(wordEnd - begin) == length && std::memcmp(begin, s_StageNames[i], length) == 0)
+            return (int)i;
+    }
+    return -1;
+}
+
+// Copies the section out of the file buffer with a #line after #version, so errors point at lines in the .shader file
+static std::string WithLineDirective(const SourceView& view)
+{
+    const char* begin = view.Data;
+    const char* end = view.Data + view.Size;
+    unsigned int line = view.FirstLine;
+
+    const char* split = begin; // Start of the first line after #version
+    for (const char* p = begin; p < end; line++)
+    {
+        const char* eol = (const char*)std::memchr(p, '\n', end - p);
+        const char* next = eol ? eol + 1 : end;
+        const char* text = SkipSpaces(p, next);
+        if (StartsWith(text, next, "#version", 8))
+        {
+            split = next;
+            line++;
+            break;
+        }
+        if (text < next && *text != '\n' && *text != '\r' && !StartsWith(text, next, "//", 2)) // Code before any #version
+            break;
+        p = next;
+    }
+    if (split == begin)
+        line = view.FirstLine;
+
+    std::string directive = "#line " + std::to_string(line) + " 0\n";
+    std::string result;
+    result.reserve(view.Size + directive.size() + 1);
+    result.append(begin, split);
+    if (split > begin && split[-1] != '\n')
+        result += '\n';
+    result += directive;
+    result.append(split, end);
+    return result;
 }
 
 ShaderProgramSource Shader::ParseShader(const std::string& filepath)
 {
-    std::ifstream stream(filepath);
+    PROFILE_FUNCTION();
+    ShaderProgramSource source;
+    source.Files.push_back(filepath);
 
-    enum class ShaderType
+    std::string contents;
+    if (!ShaderPreprocessor::ReadFile(filepath, contents)) // One read, the sections below are views into it
     {
-        NONE = -1, VERTEX = 0, FRAGMENT = 1
-    };
+        std::cout << "Failed to open shader '" << filepath << "'!" << std::endl;
+        return source;
+    }
 
-    std::string line;
-    std::stringstream ss[2];
-    ShaderType type = ShaderType::NONE;
-    while (getline(stream, line))
+    SourceView sections[(unsigned int)ShaderStage::Count];
+    int current = -1;
+    bool warnedPrologue = false;
+    const char* end = contents.data() + contents.size();
+    unsigned int line = 1;
+    for (const char* p = contents.data(); p < end; line++)
     {
-        if (line.find("#shader") != std::string::npos)
+        const char* eol = (const char*)std::memchr(p, '\n', end - p);
+        const char* next = eol ? eol + 1 : end;
+        const char* text = SkipSpaces(p, next);
+
+        if (StartsWith(text, next, "#shader", 7))
         {
-            if (line.find("vertex") != std::string::npos)
-            {
-                type = ShaderType::VERTEX;
-            }
-            else if (line.find("fragment") != std::string::npos)
+            if (current >= 0)
+                sections[current].Size = p - sections[current].Data;
+
+            current = FindStage(text + 7, next);
+            if (current < 0)
+                std::cout << "Unknown stage in '" << filepath << "' line " << line << ", expected #shader vertex, tess_control, tess_evaluation, geometry, fragment or compute" << std::endl;
+            else if (sections[current].Data)
+                std::cout << "Second " << s_StageNames[current] << " section in '" << filepath << "' line " << line << " replaces the first" << std::endl;
+
+            if (current >= 0)
             {
-                type = ShaderType::FRAGMENT;
+                sections[current].Data = next;
+                sections[current].FirstLine = line + 1;
             }
         }
-        else
+        else if (current < 0 && !warnedPrologue && text < next && *text != '\n' && *text != '\r')
         {
-            ss[(int)type] << line << "\n";
+            std::cout << "Warning : '" << filepath << "' has text before its first #shader line, it is ignored" << std::endl;
+            warnedPrologue = true;
         }
+        p = next;
     }
+    if (current >= 0)
+        sections[current].Size = end - sections[current].Data;
 
-    return { ss[0].str(), ss[1].str() };
+    for (unsigned int i = 0; i < (unsigned int)ShaderStage::Count; i++)
+    {
+        if (sections[i].Data && sections[i].Size > 0)
+            source.Stages[i] = ShaderPreprocessor::ResolveIncludes(WithLineDirective(sections[i]), filepath, source.Files);
+    }
+    return source;
+}
+
+unsigned int Shader::GetStageType(ShaderStage stage)
+{
+    return s_StageTypes[(unsigned int)stage];
 }
 
-unsigned int Shader::CompileShader(unsigned int type, const std::string& source)
+const char* Shader::GetStageName(ShaderStage stage)
 {
-    GLCall(unsigned int id = glCreateShader(type));
-    const char* src = source.c_str();
+    return s_StageNames[(unsigned int)stage];
+}
+
+bool Shader::IsStageSupported(ShaderStage stage)
+{
+    switch (stage)
+    {
+    case ShaderStage::TessControl:
+    case ShaderStage::TessEvaluation:
+        return GLEW_VERSION_4_0 || GLEW_ARB_tessellation_shader;
+    case ShaderStage::Compute:
+        return GLEW_VERSION_4_3 || GLEW_ARB_compute_shader;
+    default:
+        return true; // Geometry shaders are core since 3.2
+    }
+}
+
+unsigned int Shader::CompileShader(ShaderStage stage, const ShaderProgramSource& source)
+{
+    PROFILE_FUNCTION();
+    GLCall(unsigned int id = glCreateShader(GetStageType(stage)));
+    const char* src = source.Get(stage).c_str();
     GLCall(glShaderSource(id, 1, &src, nullptr));
     GLCall(glCompileShader(id));
 
+    if (!CheckCompileStatus(id, stage, source.Files))
+    {
+        GLCall(glDeleteShader(id));
+        return 0;
+    }
+
+    return id;
+}
+
+// Drivers start each message with the source string number ("0:12(3): error" on Mesa, "0(12) : error" on
+// NVIDIA, "ERROR: 0:12:" on AMD), swap it for the file it stands for
+static void PrintInfoLog(const char* log, const std::vector<std::string>& files)
+{
+    const char* end = log + std::strlen(log);
+    for (const char* p = log; p < end;)
+    {
+        const char* eol = (const char*)std::memchr(p, '\n', end - p);
+        const char* next = eol ? eol + 1 : end;
+
+        const char* number = p;
+        if (StartsWith(number, next, "ERROR: ", 7) || StartsWith(number, next, "WARNING: ", 9))
+            number = std::strchr(number, ' ') + 1;
+        const char* digits = number;
+        unsigned int index = 0;
+        while (digits < next && *digits >= '0' && *digits <= '9')
+            index = index * 10 + (*digits++ - '0');
+
+        if (digits > number && digits < next && (*digits == ':' || *digits == '(') && index < files.size())
+        {
+            std::cout.write(p, number - p);
+            std::cout << files[index];
+            std::cout.write(digits, next - digits);
+        }
+        else
+        {
+            std::cout.write(p, next - p);
+        }
+        p = next;
+    }
+    std::cout << std::endl;
+}
+
+bool Shader::CheckCompileStatus(unsigned int shader, ShaderStage stage, const std::vector<std::string>& files)
+{
     // Error handling for GLSL code
     int result;
-    GLCall(glGetShaderiv(id, GL_COMPILE_STATUS, &result));
+    GLCall(glGetShaderiv(shader, GL_COMPILE_STATUS, &result));
     if (result == GL_FALSE)
     {
         int length;
-        GLCall(glGetShaderiv(id, GL_INFO_LOG_LENGTH, &length));
-        char* message = (char*)alloca(length * sizeof(char));
-        GLCall(glGetShaderInfoLog(id, length, &length, message));
-        std::cout << "Failed to compile " << (type == GL_VERTEX_SHADER ? "vertex" : "fragment") << " shader!" << std::endl;
-        std::cout << message << std::endl;
-        GLCall(glDeleteShader(id));
-        return 0;
+        GLCall(glGetShaderiv(shader, GL_INFO_LOG_LENGTH, &length));
+        std::vector<char> message(length + 1);
+        GLCall(glGetShaderInfoLog(shader, length, &length, message.data()));
+        std::cout << "Failed to compile " << GetStageName(stage) << " shader!" << std::endl;
+        PrintInfoLog(message.data(), files);
+        return false;
     }
+    return true;
+}
 
-    return id;
+bool Shader::CheckLinkStatus(unsigned int program, const std::string& filepath)
+{
+    int result;
+    GLCall(glGetProgramiv(program, GL_LINK_STATUS, &result));
+    if (result == GL_FALSE)
+    {
+        int length;
+        GLCall(glGetProgramiv(program, GL_INFO_LOG_LENGTH, &length));
+        std::vector<char> message(length + 1);
+        GLCall(glGetProgramInfoLog(program, length, &length, message.data()));
+        std::cout << "Failed to link '" << filepath << "'!" << std::endl;
+        std::cout << message.data() << std::endl;
+        return false;
+    }
+    return true;
 }
 
-unsigned int Shader::CreateShader(const std::string& vertexShader, const std::string& fragmentShader)
+unsigned int Shader::CreateShader(const ShaderProgramSource& source)
 {
+    PROFILE_FUNCTION();
+    unsigned int shaders[(unsigned int)ShaderStage::Count] = {};
+    bool compiled = false, failed = false;
+    for (unsigned int i = 0; i < (unsigned int)ShaderStage::Count; i++)
+    {
+        if (!source.Has((ShaderStage)i))
+            continue;
+
+        if (!IsStageSupported((ShaderStage)i))
+        {
+            std::cout << "'" << m_FilePath << "' has a " << s_StageNames[i] << " shader, which this GL context does not support!" << std::endl;
+            failed = true;
+            continue;
+        }
+
+        shaders[i] = CompileShader((ShaderStage)i, source); // Creates a vertex, fragment... shader
+        compiled = true;
+        failed |= shaders[i] == 0;
+    }
+
+    if (!compiled || failed)
+    {
+        for (unsigned int shader : shaders)
+        {
+            GLCall(glDeleteShader(shader)); // Deleting 0 is ignored
+        }
+        return 0;
+    }
+
     GLCall(unsigned int program = glCreateProgram()); // Creates a program
-    GLCall(unsigned int vs = CompileShader(GL_VERTEX_SHADER, vertexShader)); // Creates a vertex shader
-    GLCall(unsigned int fs = CompileShader(GL_FRAGMENT_SHADER, fragmentShader)); // Creates a fragment shader
 
-    GLCall(glAttachShader(program, vs));
-    GLCall(glAttachShader(program, fs));
-    GLCall(glLinkProgram(program));
-    GLCall(glValidateProgram(program));
+    for (unsigned int shader : shaders)
+    {
+        if (shader)
+        {
+            GLCall(glAttachShader(program, shader));
+        }
+    }
+    if (ShaderCache::IsEnabled())
+    {
+        GLCall(glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE)); // Must be set before linking
+    }
+    if (m_Separable)
+    {
+        GLCall(glProgramParameteri(program, GL_PROGRAM_SEPARABLE, GL_TRUE)); // Same, and keeps outputs the next stage might read
+    }
+    GLCall(glLinkProgram(program)); // No glValidateProgram here, it checks against the state bound right now, which says nothing at load time
+
+    for (unsigned int shader : shaders)
+    {
+        GLCall(glDeleteShader(shader));
+    }
 
-    GLCall(glDeleteShader(vs));
-    GLCall(glDeleteShader(fs));
+    if (!CheckLinkStatus(program, m_FilePath))
+    {
+        GLCall(glDeleteProgram(program));
+        return 0;
+    }
 
     return program;
 }
 
+void Shader::Build(const ShaderProgramSource& source)
+{
+    PROFILE_FUNCTION();
+    m_RendererID = ShaderCache::Load(m_FilePath, source, m_Separable);
+    if (m_RendererID == 0) // Not cached, out of date or rejected by the driver
+    {
+        auto start = std::chrono::steady_clock::now();
+        m_RendererID = CreateShader(source);
+        ShaderCache::Store(m_FilePath, source, m_RendererID, std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+    }
+    ReflectUniforms();
+}
+
+void Shader::SetUniforms(const std::vector<UniformInfo>& uniforms)
+{
+    m_Uniforms = uniforms;
+    for (const UniformInfo& uniform : m_Uniforms) // The string setters can't ask GL either
+        m_UniformLocationCache.emplace(uniform.Name, uniform.Location);
+    m_DrawIndexUniform = GetUniform("u_DrawIndex");
+}
+
+void Shader::ReflectUniforms()
+{
+    m_Uniforms.clear();
+    if (m_RendererID == 0)
+        return;
+
+    int count = 0, maxLength = 0;
+    GLCall(glGetProgramiv(m_RendererID, GL_ACTIVE_UNIFORMS, &count));
+    GLCall(glGetProgramiv(m_RendererID, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength));
+
+    std::vector<char> name(maxLength + 1);
+    for (int i = 0; i < count; i++)
+    {
+        int length = 0, size = 0;
+        unsigned int type = 0;
+        GLCall(glGetActiveUniform(m_RendererID, i, (GLsizei)name.size(), &length, &size, &type, name.data()));
+
+        GLCall(int location = glGetUniformLocation(m_RendererID, name.data()));
+        if (location == -1) // Lives in a uniform block, set through a buffer instead
+            continue;
+
+        std::string uniformName(name.data(), length);
+        if (uniformName.size() > 3 && uniformName.compare(uniformName.size() - 3, 3, "[0]") == 0)
+            uniformName.resize(uniformName.size() - 3);
+
+        m_Uniforms.push_back({ uniformName, location, type, size });
+    }
+    m_DrawIndexUniform = GetUniform("u_DrawIndex");
+
+    // Shared blocks go to their fixed binding points, GLSL 3.30 has no layout(binding = N) to do it in the shader
+    int blockCount = 0;
+    GLCall(glGetProgramiv(m_RendererID, GL_ACTIVE_UNIFORM_BLOCKS, &blockCount));
+    GLCall(glGetProgramiv(m_RendererID, GL_ACTIVE_UNIFORM_BLOCK_MAX_NAME_LENGTH, &maxLength));
+    name.resize(maxLength + 1);
+    for (int i = 0; i < blockCount; i++)
+    {
+        GLCall(glGetActiveUniformBlockName(m_RendererID, i, (GLsizei)name.size(), nullptr, name.data()));
+        const UniformBlockInfo* block = FindUniformBlock(name.data());
+        if (!block)
+        {
+            std::cout << "Warning : Uniform block '" << name.data() << "' in '" << m_FilePath << "' has no binding point!" << std::endl;
+            continue;
+        }
+
+        int dataSize = 0;
+        GLCall(glGetActiveUniformBlockiv(m_RendererID, i, GL_UNIFORM_BLOCK_DATA_SIZE, &dataSize));
+        if ((unsigned int)dataSize != block->Size)
+            std::cout << "Warning : Uniform block '" << block->Name << "' is " << dataSize << " bytes in '" << m_FilePath << "' but " << block->Size << " in C++!" << std::endl;
+
+        GLCall(glUniformBlockBinding(m_RendererID, i, (unsigned int)block->Binding));
+    }
+}
+
+UniformHandle Shader::GetUniform(const char* name) const
+{
+    UniformHandle handle;
+    for (const UniformInfo& uniform : m_Uniforms)
+    {
+        if (uniform.Name == name)
+        {
+            handle.Location = uniform.Location;
+            break;
+        }
+    }
+    return handle;
+}
+
+void Shader::SetUniform(UniformHandle handle, int value) const
+{
+    if (m_Separable) // Never current, it sits in a pipeline
+    {
+        GLCall(glProgramUniform1i(m_RendererID, handle.Location, value));
+        return;
+    }
+    GLCall(glUniform1i(handle.Location, value));
+}
+
+void Shader::SetUniform(UniformHandle handle, float value) const
+{
+    if (m_Separable) // Never current, it sits in a pipeline
+    {
+        GLCall(glProgramUniform1f(m_RendererID, handle.Location, value));
+        return;
+    }
+    GLCall(glUniform1f(handle.Location, value));
+}
+
+void Shader::SetUniform(UniformHandle handle, const glm::vec2& value) const
+{
+    if (m_Separable) // Never current, it sits in a pipeline
+    {
+        GLCall(glProgramUniform2fv(m_RendererID, handle.Location, 1, &value[0]));
+        return;
+    }
+    GLCall(glUniform2fv(handle.Location, 1, &value[0]));
+}
+
+void Shader::SetUniform(UniformHandle handle, const glm::vec3& value) const
+{
+    if (m_Separable) // Never current, it sits in a pipeline
+    {
+        GLCall(glProgramUniform3fv(m_RendererID, handle.Location, 1, &value[0]));
+        return;
+    }
+    GLCall(glUniform3fv(handle.Location, 1, &value[0]));
+}
+
+void Shader::SetUniform(UniformHandle handle, const glm::vec4& value) const
+{
+    if (m_Separable) // Never current, it sits in a pipeline
+    {
+        GLCall(glProgramUniform4fv(m_RendererID, handle.Location, 1, &value[0]));
+        return;
+    }
+    GLCall(glUniform4fv(handle.Location, 1, &value[0]));
+}
+
+void Shader::SetUniform(UniformHandle handle, const glm::mat3& value) const
+{
+    if (m_Separable) // Never current, it sits in a pipeline
+    {
+        GLCall(glProgramUniformMatrix3fv(m_RendererID, handle.Location, 1, GL_FALSE, &value[0][0]));
+        return;
+    }
+    GLCall(glUniformMatrix3fv(handle.Location, 1, GL_FALSE, &value[0][0]));
+}
+
+void Shader::SetUniform(UniformHandle handle, const glm::mat4& value) const
+{
+    if (m_Separable) // Never current, it sits in a pipeline
+    {
+        GLCall(glProgramUniformMatrix4fv(m_RendererID, handle.Location, 1, GL_FALSE, &value[0][0]));
+        return;
+    }
+    GLCall(glUniformMatrix4fv(handle.Location, 1, GL_FALSE, &value[0][0]));
+}
+
+void Shader::SetUniformArray(UniformHandle handle, int count, const int* values) const
+{
+    if (m_Separable) // Never current, it sits in a pipeline
+    {
+        GLCall(glProgramUniform1iv(m_RendererID, handle.Location, count, values));
+        return;
+    }
+    GLCall(glUniform1iv(handle.Location, count, values));
+}
+
+void Shader::SetUniformArray(UniformHandle handle, int count, const float* values) const
+{
+    if (m_Separable) // Never current, it sits in a pipeline
+    {
+        GLCall(glProgramUniform1fv(m_RendererID, handle.Location, count, values));
+        return;
+    }
+    GLCall(glUniform1fv(handle.Location, count, values));
+}
+
+void Shader::SetUniformArray(UniformHandle handle, int count, const glm::vec4* values) const
+{
+    if (m_Separable) // Never current, it sits in a pipeline
+    {
+        GLCall(glProgramUniform4fv(m_RendererID, handle.Location, count, &values[0][0]));
+        return;
+    }
+    GLCall(glUniform4fv(handle.Location, count, &values[0][0]));
+}
+
+void Shader::SetUniformArray(UniformHandle handle, int count, const glm::mat4* values) const
+{
+    if (m_Separable) // Never current, it sits in a pipeline
+    {
+        GLCall(glProgramUniformMatrix4fv(m_RendererID, handle.Location, count, GL_FALSE, &values[0][0][0]));
+        return;
+    }
+    GLCall(glUniformMatrix4fv(handle.Location, count, GL_FALSE, &values[0][0][0]));
+}
+
 void Shader::Bind() const
 {
-    GLCall(glUseProgram(m_RendererID));
+    GLState::UseProgram(m_RendererID);
 }
 
 void Shader::Unbind() const
 {
-    GLCall(glUseProgram(0));
+    GLState::UseProgram(0);
 }
 
 void Shader::SetUniform4f(const std::string& name, float f0, float f1, float f2, float f3)
 {
+    if (m_Separable) // Never current, it sits in a pipeline
+    {
+        GLCall(glProgramUniform4f(m_RendererID, GetUniformLocation(name), f0, f1, f2, f3));
+        return;
+    }
     GLCall(glUniform4f(GetUniformLocation(name), f0, f1, f2, f3));
 }
 
 void Shader::SetUniform1f(const std::string& name, float f0)
 {
+    if (m_Separable) // Never current, it sits in a pipeline
+    {
+        GLCall(glProgramUniform1f(m_RendererID, GetUniformLocation(name), f0));
+        return;
+    }
     GLCall(glUniform1f(GetUniformLocation(name), f0));
 }
 
 void Shader::SetUniform1i(const std::string& name, int i0)
 {
+    if (m_Separable) // Never current, it sits in a pipeline
+    {
+        GLCall(glProgramUniform1i(m_RendererID, GetUniformLocation(name), i0));
+        return;
+    }
     GLCall(glUniform1i(GetUniformLocation(name), i0));
 }
 
-void Shader::SetUniformMat4f(const std::string& name, const glm::mat4 matrix)
+void Shader::SetUniform1iv(const std::string& name, int count, const int* values)
 {
+    if (m_Separable) // Never current, it sits in a pipeline
+    {
+        GLCall(glProgramUniform1iv(m_RendererID, GetUniformLocation(name), count, values));
+        return;
+    }
+    GLCall(glUniform1iv(GetUniformLocation(name), count, values));
+}
+
+void Shader::SetUniformMat4f(const std::string& name, const glm::mat4& matrix)
+{
+    if (m_Separable) // Never current, it sits in a pipeline
+    {
+        GLCall(glProgramUniformMatrix4fv(m_RendererID, GetUniformLocation(name), 1, GL_FALSE, &matrix[0][0]));
+        return;
+    }
     GLCall(glUniformMatrix4fv(GetUniformLocation(name), 1, GL_FALSE, &matrix[0][0]));
 }
 
 int Shader::GetUniformLocation(const std::string& name)
 {
-    if (m_UniformLocationCache.find(name) != m_UniformLocationCache.end()) // Checks hashmap to see if 'name' has already been declared, if so, returns the integer ID
-        return m_UniformLocationCache[name];
+    auto it = m_UniformLocationCache.find(name); // Checks hashmap to see if 'name' has already been declared, if so, returns the integer ID
+    if (it != m_UniformLocationCache.end())
+        return it->second;
 
-    GLCall(int location = glGetUniformLocation(m_RendererID, name.c_str()));
+    GLCall(int location = glGetUniformLocation(m_RendererID, name.c_str())); // Also takes element names like "u_Array[2]", which the reflected table doesn't
     if (location == -1)
     {
         std::cout << "Warning : Uniform '" << name << "' doesn't exist!" << std::endl;
     }
 
-    m_UniformLocationCache[name] = location; // Otherwise the hashmap is appended with the ID at 'name'
+    m_UniformLocationCache.emplace(name, location); // Otherwise the hashmap is appended with the ID at 'name'
     return location;
 }
@@ -4,13 +4,37 @@
 
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 #include "glm.hpp"
 
+enum class ShaderStage : unsigned int // "#shader vertex", "#shader tess_control"... in a .shader file
+{
+	Vertex = 0, TessControl, TessEvaluation, Geometry, Fragment, Compute, Count
+};
+
 struct ShaderProgramSource
 {
-	std::string VertexSource;
-	std::string FragmentSource;
+	std::string Stages[(unsigned int)ShaderStage::Count]; // Empty when the file has no such section
+	std::vector<std::string> Files; // By GLSL source string number, 0 is the .shader file and the rest are #includes
+
+	inline const std::string& Get(ShaderStage stage) const { return Stages[(unsigned int)stage]; }
+	inline bool Has(ShaderStage stage) const { return !Stages[(unsigned int)stage].empty(); }
+};
+
+struct UniformInfo // One active uniform, as reported by glGetActiveUniform
+{
+	std::string Name; // Arrays without the "[0]"
+	int Location;
+	unsigned int Type; // GL_FLOAT_MAT4, GL_SAMPLER_2D...
+	int Size; // Array length, 1 otherwise
+};
+
+struct UniformHandle // Resolved once with Shader::GetUniform, only valid for the shader it came from
+{
+	int Location = -1;
+
+	inline bool IsValid() const { return Location != -1; }
 };
 
 class Shader
@@ -18,23 +42,63 @@ class Shader
 private:
 	std::string m_FilePath;
 	unsigned int m_RendererID;
+	std::vector<UniformInfo> m_Uniforms; // Filled right after linking
+	UniformHandle m_DrawIndexUniform; // "u_DrawIndex", set by Renderer::Draw for every DrawBlock draw
+	bool m_Separable; // One stage of a ShaderPipeline, never made current so uniforms go through glProgramUniform
 	// Caching for uniforms;
 	std::unordered_map<std::string, int> m_UniformLocationCache;
 public:
 	Shader(const std::string& filepath);
+	Shader(const std::string& name, const ShaderProgramSource& source); // Already preprocessed source, 'name' keys the ShaderCache entry
+	Shader(const std::string& name, const ShaderProgramSource& source, ShaderStage stage); // Only 'stage', linked separable for a ShaderPipeline
+	Shader(const std::string& filepath, unsigned int program); // Takes ownership of an already linked program, see ShaderCompiler
+	Shader(const std::string& filepath, unsigned int program, const std::vector<UniformInfo>& uniforms); // Same, for SPIR-V programs GL has no uniform names for
 	~Shader();
 
 	void Bind() const;
 	void Unbind() const;
 
-	// Set uniforms
+	inline unsigned int GetRendererID() const { return m_RendererID; }
+	inline const std::string& GetFilePath() const { return m_FilePath; }
+	inline const std::vector<UniformInfo>& GetUniforms() const { return m_Uniforms; }
+	inline UniformHandle GetDrawIndexUniform() const { return m_DrawIndexUniform; }
+	inline bool IsSeparable() const { return m_Separable; }
+
+	// Linear search of the reflected uniforms, do it once and keep the handle. Invalid if there is no such
+	// active uniform, setting an invalid handle does nothing
+	UniformHandle GetUniform(const char* name) const;
+
+	// Set uniforms through a handle, no lookups or allocations. The shader must be bound, unless it is separable
+	void SetUniform(UniformHandle handle, int value) const;
+	void SetUniform(UniformHandle handle, float value) const;
+	void SetUniform(UniformHandle handle, const glm::vec2& value) const;
+	void SetUniform(UniformHandle handle, const glm::vec3& value) const;
+	void SetUniform(UniformHandle handle, const glm::vec4& value) const;
+	void SetUniform(UniformHandle handle, const glm::mat3& value) const;
+	void SetUniform(UniformHandle handle, const glm::mat4& value) const;
+	void SetUniformArray(UniformHandle handle, int count, const int* values) const;
+	void SetUniformArray(UniformHandle handle, int count, const float* values) const;
+	void SetUniformArray(UniformHandle handle, int count, const glm::vec4* values) const;
+	void SetUniformArray(UniformHandle handle, int count, const glm::mat4* values) const;
+
+	// Set uniforms by name, looked up in a hashmap on every call
 	void SetUniform4f(const std::string& name, float f0, float f1, float f2, float f3);
 	void SetUniform1f(const std::string& name, float f0);
 	void SetUniform1i(const std::string& name, int i0);
-	void SetUniformMat4f(const std::string& name, const glm::mat4 matrix);
+	void SetUniform1iv(const std::string& name, int count, const int* values);
+	void SetUniformMat4f(const std::string& name, const glm::mat4& matrix);
+
+	static ShaderProgramSource ParseShader(const std::string& filepath); // Splits the stages and resolves #includes
+	static bool CheckCompileStatus(unsigned int shader, ShaderStage stage, const std::vector<std::string>& files); // Prints the info log with file names and returns false on failure
+	static bool CheckLinkStatus(unsigned int program, const std::string& filepath);
+	static unsigned int GetStageType(ShaderStage stage); // GL_VERTEX_SHADER...
+	static const char* GetStageName(ShaderStage stage);
+	static bool IsStageSupported(ShaderStage stage); // Tessellation needs GL 4.0, compute 4.3 (or their ARB extensions)
 private:
-	ShaderProgramSource ParseShader(const std::string& filepath);
-	unsigned int CompileShader(unsigned int type, const std::string& source);
-	unsigned int CreateShader(const std::string& vertexShader, const std::string& fragmentShader);
+	unsigned int CompileShader(ShaderStage stage, const ShaderProgramSource& source);
+	unsigned int CreateShader(const ShaderProgramSource& source);
+	void Build(const ShaderProgramSource& source); // ShaderCache or CreateShader, then ReflectUniforms
+	void SetUniforms(const std::vector<UniformInfo>& uniforms);
+	void ReflectUniforms();
 	int GetUniformLocation(const std::string& name);
 };
\ No newline at end of file
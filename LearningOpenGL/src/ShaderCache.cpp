@@ -0,0 +1,196 @@
+#include "ShaderCache.h"
+
+#include "Shader.h"
+#include "Hash.h"
+
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+#ifdef _WIN32
+#include <direct.h>
+#else
+#include <sys/stat.h>
+#endif
+
+struct ShaderCacheHeader
+{
+	uint32_t Magic;
+	uint32_t Version;
+	uint64_t SourceHash;
+	uint64_t DriverHash;
+	uint32_t BinaryFormat;
+	uint32_t BinaryLength;
+	double CompileMilliseconds; // What a hit saves
+};
+
+static const uint32_t s_Magic = 0x42505347; // "GSPB"
+static const uint32_t s_Version = 1;
+
+static bool s_Enabled = false;
+static std::string s_Directory;
+static uint64_t s_DriverHash = 0;
+static ShaderCacheStats s_Stats;
+
+static uint64_t HashString(const char* text, uint64_t hash)
+{
+	return Hash::FNV1a(text, std::char_traits<char>::length(text) + 1, hash); // Terminator included so "ab"+"c" != "a"+"bc"
+}
+
+static uint64_t HashSource(const ShaderProgramSource& source)
+{
+	uint64_t hash = Hash::FNVOffsetBasis;
+	for (const std::string& stage : source.Stages) // Absent stages still hash their terminator, so a section moving between stages changes the hash
+		hash = HashString(stage.c_str(), hash);
+	return hash;
+}
+
+static std::string EntryPath(const std::string& filepath)
+{
+	static const char digits[] = "0123456789abcdef";
+	uint64_t hash = HashString(filepath.c_str(), Hash::FNVOffsetBasis);
+
+	std::string name(16, '0');
+	for (int i = 15; i >= 0; i--, hash >>= 4)
+		name[i] = digits[hash & 0xf];
+	return s_Directory + "/" + name + ".bin";
+}
+
+bool ShaderCache::Init(const std::string& directory)
+{
+	s_Enabled = false;
+	if (!GLEW_VERSION_4_1 && !GLEW_ARB_get_program_binary)
+	{
+		std::cout << "Program binaries are not supported, shader cache disabled" << std::endl;
+		return false;
+	}
+
+	int formatCount = 0;
+	GLCall(glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formatCount));
+	if (formatCount <= 0)
+	{
+		std::cout << "Driver offers no program binary formats, shader cache disabled" << std::endl;
+		return false;
+	}
+	std::vector<int> formats(formatCount);
+	GLCall(glGetIntegerv(GL_PROGRAM_BINARY_FORMATS, formats.data()));
+
+	s_DriverHash = Hash::FNVOffsetBasis;
+	s_DriverHash = HashString((const char*)glGetString(GL_VENDOR), s_DriverHash);
+	s_DriverHash = HashString((const char*)glGetString(GL_RENDERER), s_DriverHash);
+	s_DriverHash = HashString((const char*)glGetString(GL_VERSION), s_DriverHash);
+	s_DriverHash = Hash::FNV1a(formats.data(), formats.size() * sizeof(int), s_DriverHash);
+
+#ifdef _WIN32
+	_mkdir(directory.c_str());
+#else
+	mkdir(directory.c_str(), 0755);
+#endif
+	s_Directory = directory;
+	s_Enabled = true;
+	return true;
+}
+
+void ShaderCache::Shutdown()
+{
+	s_Enabled = false;
+}
+
+bool ShaderCache::IsEnabled()
+{
+	return s_Enabled;
+}
+
+unsigned int ShaderCache::Load(const std::string& filepath, const ShaderProgramSource& source, bool separable)
+{
+	if (!s_Enabled)
+		return 0;
+
+	ShaderCacheHeader header;
+	std::ifstream stream(EntryPath(filepath), std::ios::binary);
+	if (!stream.read((char*)&header, sizeof(header))
+		|| header.Magic != s_Magic || header.Version != s_Version
+		|| header.SourceHash != HashSource(source) || header.DriverHash != s_DriverHash)
+	{
+		s_Stats.Misses++;
+		return 0;
+	}
+
+	std::vector<char> binary(header.BinaryLength);
+	if (!stream.read(binary.data(), binary.size()))
+	{
+		s_Stats.Misses++;
+		return 0;
+	}
+
+	auto start = std::chrono::steady_clock::now();
+	GLCall(unsigned int program = glCreateProgram());
+	if (separable)
+	{
+		GLCall(glProgramParameteri(program, GL_PROGRAM_SEPARABLE, GL_TRUE)); // Not every driver keeps it in the binary
+	}
+	GLCall(glProgramBinary(program, header.BinaryFormat, binary.data(), header.BinaryLength));
+
+	int linked = GL_FALSE;
+	GLCall(glGetProgramiv(program, GL_LINK_STATUS, &linked));
+	if (linked == GL_FALSE) // Can happen even with a matching driver string, e.g. after a GPU switch
+	{
+		GLCall(glDeleteProgram(program));
+		s_Stats.Rejected++;
+		return 0;
+	}
+
+	double milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	s_Stats.Hits++;
+	s_Stats.LoadMilliseconds += milliseconds;
+	s_Stats.SavedMilliseconds += header.CompileMilliseconds - milliseconds;
+	return program;
+}
+
+void ShaderCache::Store(const std::string& filepath, const ShaderProgramSource& source, unsigned int program, double compileMilliseconds)
+{
+	if (!s_Enabled || program == 0)
+		return;
+
+	int linked = GL_FALSE, length = 0;
+	GLCall(glGetProgramiv(program, GL_LINK_STATUS, &linked));
+	GLCall(glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length));
+	if (linked == GL_FALSE || length <= 0)
+		return;
+
+	std::vector<char> binary(length);
+	unsigned int format = 0;
+	GLCall(glGetProgramBinary(program, length, &length, &format, binary.data()));
+
+	ShaderCacheHeader header;
+	header.Magic = s_Magic;
+	header.Version = s_Version;
+	header.SourceHash = HashSource(source);
+	header.DriverHash = s_DriverHash;
+	header.BinaryFormat = format;
+	header.BinaryLength = (uint32_t)length;
+	header.CompileMilliseconds = compileMilliseconds;
+
+	std::ofstream stream(EntryPath(filepath), std::ios::binary | std::ios::trunc);
+	stream.write((const char*)&header, sizeof(header));
+	stream.write(binary.data(), length);
+	if (!stream)
+		std::cout << "Failed to write shader cache entry for '" << filepath << "'" << std::endl;
+}
+
+const ShaderCacheStats& ShaderCache::GetStats()
+{
+	return s_Stats;
+}
+
+void ShaderCache::PrintStats()
+{
+	unsigned int lookups = s_Stats.Hits + s_Stats.Misses + s_Stats.Rejected;
+	if (lookups == 0)
+		return;
+
+	std::cout << "[ShaderCache] " << s_Stats.Hits << "/" << lookups << " hits (" << 100.0 * s_Stats.Hits / lookups << "%), "
+		<< s_Stats.Rejected << " rejected, " << s_Stats.LoadMilliseconds << " ms loading, "
+		<< s_Stats.SavedMilliseconds << " ms saved" << std::endl;
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include "GLPrerequisites.h"
+
+#include <cstdint>
+#include <string>
+
+struct ShaderProgramSource;
+
+struct ShaderCacheStats
+{
+	unsigned int Hits = 0;
+	unsigned int Misses = 0; // No entry, or one made for different source or a different driver
+	unsigned int Rejected = 0; // Entry matched but the driver refused the binary, recompiled instead
+	double LoadMilliseconds = 0.0; // Spent in glProgramBinary on hits
+	double SavedMilliseconds = 0.0; // Compile time recorded with each hit entry, minus the time it took to load
+};
+
+/*
+On-disk cache of linked programs (glGetProgramBinary / glProgramBinary), one file per shader path.
+
+Each entry remembers a hash of the source it was built from and of the driver vendor, renderer, version
+and supported binary formats, so editing a shader or updating the driver turns it into a miss and the
+entry is overwritten by the next compile. A binary the driver still refuses is reported as Rejected and
+the program is compiled from source as usual.
+
+Needs GL 4.1 or ARB_get_program_binary and at least one binary format, otherwise Init returns false and
+every Load is a miss.
+*/
+class ShaderCache
+{
+private:
+	ShaderCache() {} // Static only
+public:
+	static bool Init(const std::string& directory); // After the context is current
+	static void Shutdown();
+	static bool IsEnabled();
+
+	static unsigned int Load(const std::string& filepath, const ShaderProgramSource& source, bool separable = false); // Linked program, or 0 to compile it
+	static void Store(const std::string& filepath, const ShaderProgramSource& source, unsigned int program, double compileMilliseconds);
+
+	static const ShaderCacheStats& GetStats();
+	static void PrintStats();
+};
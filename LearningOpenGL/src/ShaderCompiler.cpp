@@ -0,0 +1,220 @@
+#include "ShaderCompiler.h"
+
+#include "CPUProfiler.h"
+#include "ShaderCache.h"
+#include "ShaderPreprocessor.h"
+#include "ShaderSpirv.h"
+
+#include <iostream>
+
+ShaderCompiler::ShaderCompiler(unsigned int maxThreads)
+	: m_Pending(0), m_Parallel(GLEW_KHR_parallel_shader_compile || GLEW_ARB_parallel_shader_compile)
+{
+	if (GLEW_KHR_parallel_shader_compile)
+	{
+		GLCall(glMaxShaderCompilerThreadsKHR(maxThreads));
+	}
+	else if (GLEW_ARB_parallel_shader_compile)
+	{
+		GLCall(glMaxShaderCompilerThreadsARB(maxThreads));
+	}
+}
+
+ShaderCompiler::~ShaderCompiler()
+{
+	for (Job& job : m_Jobs) // Anything never taken
+	{
+		DeleteShaders(job);
+		GLCall(glDeleteProgram(job.Program));
+	}
+}
+
+ShaderHandle ShaderCompiler::Submit(const std::string& filepath, const std::vector<std::string>& defines)
+{
+	PROFILE_FUNCTION();
+	ShaderHandle handle;
+	handle.Index = (unsigned int)m_Jobs.size();
+
+	m_Jobs.emplace_back();
+	Job& job = m_Jobs.back();
+	job.FilePath = ShaderPreprocessor::VariantName(filepath, defines);
+	job.Start = std::chrono::steady_clock::now();
+
+	SpirvProgram spirv = ShaderSpirv::Load(filepath, defines); // Specializing is quick, no need to spread it over Polls
+	if (spirv.Program != 0)
+	{
+		job.Program = spirv.Program;
+		job.SpirvUniforms = std::move(spirv.Uniforms);
+		job.Spirv = true;
+		job.CurrentStage = Stage::Done;
+		job.Status = ShaderStatus::Ready;
+		return handle;
+	}
+
+	job.Source = ShaderPreprocessor::InjectDefines(Shader::ParseShader(filepath), defines);
+	job.Program = ShaderCache::Load(job.FilePath, job.Source);
+	if (job.Program != 0)
+	{
+		job.CurrentStage = Stage::Done;
+		job.Status = ShaderStatus::Ready;
+		return handle;
+	}
+
+	for (unsigned int i = 0; i < (unsigned int)ShaderStage::Count; i++)
+	{
+		if (!job.Source.Has((ShaderStage)i))
+			continue;
+		if (!Shader::IsStageSupported((ShaderStage)i))
+		{
+			std::cout << "'" << job.FilePath << "' has a " << Shader::GetStageName((ShaderStage)i) << " shader, which this GL context does not support!" << std::endl;
+			m_Pending++; // Fail takes it back off
+			Fail(job);
+			return handle;
+		}
+
+		const char* source = job.Source.Stages[i].c_str();
+		GLCall(job.Shaders[i] = glCreateShader(Shader::GetStageType((ShaderStage)i)));
+		GLCall(glShaderSource(job.Shaders[i], 1, &source, nullptr));
+		GLCall(glCompileShader(job.Shaders[i]));
+	}
+
+	m_Pending++;
+	return handle;
+}
+
+unsigned int ShaderCompiler::Poll()
+{
+	if (m_Pending == 0)
+		return 0;
+
+	PROFILE_FUNCTION();
+	for (Job& job : m_Jobs)
+	{
+		if (job.CurrentStage == Stage::Compiling && IsCompiled(job))
+		{
+			bool compiled = false, failed = false;
+			for (unsigned int i = 0; i < (unsigned int)ShaderStage::Count; i++)
+			{
+				if (job.Shaders[i] == 0)
+					continue;
+				compiled = true;
+				failed |= !Shader::CheckCompileStatus(job.Shaders[i], (ShaderStage)i, job.Source.Files); // Every stage reports its errors
+			}
+			if (!compiled || failed)
+			{
+				if (!compiled)
+					std::cout << "No #shader sections in '" << job.FilePath << "'" << std::endl;
+				Fail(job);
+				continue;
+			}
+
+			GLCall(job.Program = glCreateProgram());
+			for (unsigned int shader : job.Shaders)
+			{
+				if (shader)
+				{
+					GLCall(glAttachShader(job.Program, shader));
+				}
+			}
+			if (ShaderCache::IsEnabled())
+			{
+				GLCall(glProgramParameteri(job.Program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE));
+			}
+			GLCall(glLinkProgram(job.Program));
+			job.CurrentStage = Stage::Linking;
+		}
+		else if (job.CurrentStage == Stage::Linking && IsComplete(job.Program, true))
+		{
+			DeleteShaders(job); // Only flagged, GL frees them with the program
+
+			if (!Shader::CheckLinkStatus(job.Program, job.FilePath))
+			{
+				Fail(job);
+				continue;
+			}
+
+			double milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - job.Start).count();
+			ShaderCache::Store(job.FilePath, job.Source, job.Program, milliseconds);
+
+			job.CurrentStage = Stage::Done;
+			job.Status = ShaderStatus::Ready;
+			m_Pending--;
+		}
+	}
+	return m_Pending;
+}
+
+void ShaderCompiler::WaitAll()
+{
+	while (Poll() > 0);
+}
+
+ShaderStatus ShaderCompiler::GetStatus(ShaderHandle handle) const
+{
+	if (handle.Index >= m_Jobs.size())
+		return ShaderStatus::Failed;
+	return m_Jobs[handle.Index].Status;
+}
+
+std::unique_ptr<Shader> ShaderCompiler::Take(ShaderHandle handle)
+{
+	if (GetStatus(handle) != ShaderStatus::Ready)
+		return nullptr;
+
+	Job& job = m_Jobs[handle.Index];
+	if (job.Program == 0)
+		return nullptr;
+
+	std::unique_ptr<Shader> shader = job.Spirv ? std::make_unique<Shader>(job.FilePath, job.Program, job.SpirvUniforms)
+	                                           : std::make_unique<Shader>(job.FilePath, job.Program);
+	job.Program = 0;
+	job.Source = ShaderProgramSource();
+	return shader;
+}
+
+bool ShaderCompiler::IsComplete(unsigned int object, bool program) const
+{
+	if (!m_Parallel)
+		return true; // The status query right after blocks until it is
+
+	int complete = GL_FALSE;
+	if (program)
+	{
+		GLCall(glGetProgramiv(object, GL_COMPLETION_STATUS_KHR, &complete));
+	}
+	else
+	{
+		GLCall(glGetShaderiv(object, GL_COMPLETION_STATUS_KHR, &complete));
+	}
+	return complete != GL_FALSE;
+}
+
+bool ShaderCompiler::IsCompiled(const Job& job) const
+{
+	for (unsigned int shader : job.Shaders)
+	{
+		if (shader && !IsComplete(shader, false))
+			return false;
+	}
+	return true;
+}
+
+void ShaderCompiler::DeleteShaders(Job& job)
+{
+	for (unsigned int& shader : job.Shaders)
+	{
+		GLCall(glDeleteShader(shader));
+		shader = 0;
+	}
+}
+
+void ShaderCompiler::Fail(Job& job)
+{
+	DeleteShaders(job);
+	GLCall(glDeleteProgram(job.Program));
+	job.Program = 0;
+
+	job.CurrentStage = Stage::Done;
+	job.Status = ShaderStatus::Failed;
+	m_Pending--;
+}
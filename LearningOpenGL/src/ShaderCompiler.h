@@ -0,0 +1,77 @@
+#pragma once
+
+#include "GLPrerequisites.h"
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "Shader.h"
+
+enum class ShaderStatus
+{
+	Pending, Ready, Failed
+};
+
+struct ShaderHandle
+{
+	unsigned int Index = 0xFFFFFFFF;
+
+	inline bool IsValid() const { return Index != 0xFFFFFFFF; }
+};
+
+/*
+Compiles programs without blocking the thread that asked for them. Submit starts the compile of every
+stage in the file straight away and returns a handle, Poll (once a frame, say) links whatever has
+finished compiling and picks up finished links. With KHR/ARB_parallel_shader_compile the driver does the
+work on its own threads and Poll only asks GL_COMPLETION_STATUS, so submitting everything up front lets
+all of it compile at once. Without the extension Poll blocks on each stage, still linking only after
+every compile was submitted.
+
+Programs found in the ShaderCache or built from SPIR-V (see ShaderSpirv) are Ready as soon as they are
+submitted.
+*/
+class ShaderCompiler
+{
+private:
+	enum class Stage
+	{
+		Compiling, Linking, Done
+	};
+
+	struct Job
+	{
+		std::string FilePath;
+		ShaderProgramSource Source;
+		unsigned int Shaders[(unsigned int)ShaderStage::Count] = {}; // 0 for stages the file does not have
+		unsigned int Program = 0;
+		bool Spirv = false; // Loaded by ShaderSpirv, reflected from the modules
+		std::vector<UniformInfo> SpirvUniforms;
+		Stage CurrentStage = Stage::Compiling;
+		ShaderStatus Status = ShaderStatus::Pending;
+		std::chrono::steady_clock::time_point Start;
+	};
+
+	std::vector<Job> m_Jobs; // Indexed by ShaderHandle
+	unsigned int m_Pending;
+	bool m_Parallel;
+public:
+	ShaderCompiler(unsigned int maxThreads = 0xFFFFFFFF); // 0xFFFFFFFF lets the driver pick, only used with the extension
+	~ShaderCompiler();
+
+	ShaderHandle Submit(const std::string& filepath, const std::vector<std::string>& defines = {}); // See ShaderPreprocessor for defines
+	unsigned int Poll(); // Returns how many programs are still pending
+	void WaitAll();
+
+	ShaderStatus GetStatus(ShaderHandle handle) const;
+	std::unique_ptr<Shader> Take(ShaderHandle handle); // The finished Shader, once. nullptr if it isn't Ready or was already taken
+
+	inline bool IsParallel() const { return m_Parallel; }
+	inline unsigned int GetPendingCount() const { return m_Pending; }
+private:
+	bool IsComplete(unsigned int object, bool program) const;
+	bool IsCompiled(const Job& job) const;
+	void DeleteShaders(Job& job);
+	void Fail(Job& job);
+};
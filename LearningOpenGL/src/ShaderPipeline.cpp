@@ -0,0 +1,131 @@
+#include "ShaderPipeline.h"
+
+#include "GLState.h"
+#include "Hash.h"
+
+#include <iostream>
+#include <vector>
+
+static const unsigned int s_StageBits[PipelineStageCount] = { GL_VERTEX_SHADER_BIT, GL_TESS_CONTROL_SHADER_BIT, GL_TESS_EVALUATION_SHADER_BIT, GL_GEOMETRY_SHADER_BIT, GL_FRAGMENT_SHADER_BIT };
+
+ShaderPipeline::ShaderPipeline(const Shader* const stages[PipelineStageCount])
+    : m_RendererID(0)
+{
+    GLCall(glGenProgramPipelines(1, &m_RendererID));
+    for (unsigned int i = 0; i < PipelineStageCount; i++)
+    {
+        m_Stages[i] = stages[i];
+        if (!stages[i])
+            continue;
+
+        ASSERT(stages[i]->IsSeparable());
+        GLCall(glUseProgramStages(m_RendererID, s_StageBits[i], stages[i]->GetRendererID())); // No bind needed, the pipeline is made by this call
+    }
+}
+
+ShaderPipeline::~ShaderPipeline()
+{
+    GLCall(glDeleteProgramPipelines(1, &m_RendererID));
+    GLState::OnProgramPipelineDeleted(m_RendererID);
+}
+
+void ShaderPipeline::Bind() const
+{
+    GLState::BindProgramPipeline(m_RendererID);
+}
+
+void ShaderPipeline::Unbind() const
+{
+    GLState::BindProgramPipeline(0);
+}
+
+bool ShaderPipeline::Validate() const
+{
+    GLCall(glValidateProgramPipeline(m_RendererID));
+    int valid = GL_FALSE, length = 0;
+    GLCall(glGetProgramPipelineiv(m_RendererID, GL_VALIDATE_STATUS, &valid));
+    if (valid == GL_TRUE)
+        return true;
+
+    GLCall(glGetProgramPipelineiv(m_RendererID, GL_INFO_LOG_LENGTH, &length));
+    std::vector<char> message(length + 1, '\0');
+    GLCall(glGetProgramPipelineInfoLog(m_RendererID, length, nullptr, message.data()));
+    std::cout << "Program pipeline of";
+    for (const Shader* stage : m_Stages)
+    {
+        if (stage)
+            std::cout << " '" << stage->GetFilePath() << "'";
+    }
+    std::cout << " is not valid!" << std::endl;
+    std::cout << message.data() << std::endl;
+    return false;
+}
+
+bool ShaderPipeline::IsSupported()
+{
+    return GLEW_VERSION_4_1 || GLEW_ARB_separate_shader_objects;
+}
+
+bool ShaderPipelineCache::Key::operator==(const Key& other) const
+{
+    for (unsigned int i = 0; i < PipelineStageCount; i++)
+    {
+        if (Programs[i] != other.Programs[i])
+            return false;
+    }
+    return true;
+}
+
+size_t ShaderPipelineCache::KeyHash::operator()(const Key& key) const
+{
+    return Hash::Fold(Hash::FNV1a(key.Programs, sizeof(key.Programs))); // Over the program names
+}
+
+ShaderPipeline& ShaderPipelineCache::Get(const Shader* vertex, const Shader* fragment)
+{
+    const Shader* stages[PipelineStageCount] = {};
+    stages[(unsigned int)ShaderStage::Vertex] = vertex;
+    stages[(unsigned int)ShaderStage::Fragment] = fragment;
+    return Get(stages);
+}
+
+ShaderPipeline& ShaderPipelineCache::Get(const Shader* const stages[PipelineStageCount])
+{
+    m_Stats.Lookups++;
+    Key key;
+    for (unsigned int i = 0; i < PipelineStageCount; i++)
+        key.Programs[i] = stages[i] ? stages[i]->GetRendererID() : 0;
+
+    auto it = m_Pipelines.find(key);
+    if (it != m_Pipelines.end())
+        return *it->second;
+
+    m_Stats.Created++;
+    std::unique_ptr<ShaderPipeline> pipeline = std::make_unique<ShaderPipeline>(stages);
+#if GLCALL_MODE == GLCALL_MODE_DEBUG
+    pipeline->Validate(); // Catches stage outputs and inputs that don't line up, which linking the stages apart can't
+#endif
+    ShaderPipeline& result = *pipeline;
+    m_Pipelines.emplace(key, std::move(pipeline));
+    return result;
+}
+
+void ShaderPipelineCache::Evict(const Shader& stage)
+{
+    for (auto it = m_Pipelines.begin(); it != m_Pipelines.end();)
+    {
+        bool uses = false;
+        for (unsigned int i = 0; i < PipelineStageCount; i++)
+            uses |= it->second->GetStage((ShaderStage)i) == &stage;
+
+        if (uses)
+            it = m_Pipelines.erase(it);
+        else
+            ++it;
+    }
+}
+
+void ShaderPipelineCache::Clear()
+{
+    m_Pipelines.clear();
+}
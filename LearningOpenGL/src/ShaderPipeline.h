@@ -0,0 +1,81 @@
+#pragma once
+
+#include "GLPrerequisites.h"
+
+#include <cstddef>
+#include <memory>
+#include <unordered_map>
+
+#include "Shader.h"
+
+static const unsigned int PipelineStageCount = (unsigned int)ShaderStage::Compute; // Vertex to fragment, compute has no place in a draw
+
+/*
+Program pipeline object (GL 4.1 / ARB_separate_shader_objects) put together from separable single-stage
+programs, see the Shader(name, source, stage) constructor and ShaderVariants::GetStage. Stages link on
+their own, so N vertex and M fragment variants cost N + M links instead of N * M, and each stage's
+uniforms stay set on its program whatever it gets paired with.
+*/
+class ShaderPipeline
+{
+private:
+	unsigned int m_RendererID;
+	const Shader* m_Stages[PipelineStageCount]; // nullptr for stages the pipeline leaves out
+public:
+	ShaderPipeline(const Shader* const stages[PipelineStageCount]);
+	~ShaderPipeline();
+
+	void Bind() const;
+	void Unbind() const;
+	bool Validate() const; // glValidateProgramPipeline, prints the info log on failure (e.g. stage interfaces that don't match)
+
+	inline unsigned int GetRendererID() const { return m_RendererID; }
+	inline const Shader* GetStage(ShaderStage stage) const { return m_Stages[(unsigned int)stage]; }
+
+	static bool IsSupported();
+};
+
+struct ShaderPipelineStats
+{
+	unsigned int Lookups = 0;
+	unsigned int Created = 0; // Lookups that had to make a pipeline, the rest found one
+};
+
+/*
+Pipelines by the tuple of stage programs in them. Asking again for the same stages gives the same
+pipeline, so swapping only the fragment stage finds (or makes once) the pipeline with the new fragment
+program and the same vertex one. Nothing is relinked and the vertex program's uniforms are untouched.
+
+    ShaderVariants objects("res/shaders/Object.shader", { "TEXTURED" });
+    ShaderPipelineCache pipelines;
+    ShaderPipeline& textured = pipelines.Get(&objects.GetStage(0, ShaderStage::Vertex), &objects.GetStage(1, ShaderStage::Fragment));
+
+Pipelines hold the programs by name, call Evict before deleting a stage still in the cache.
+*/
+class ShaderPipelineCache
+{
+private:
+	struct Key
+	{
+		unsigned int Programs[PipelineStageCount];
+
+		bool operator==(const Key& other) const;
+	};
+
+	struct KeyHash
+	{
+		size_t operator()(const Key& key) const;
+	};
+
+	std::unordered_map<Key, std::unique_ptr<ShaderPipeline>, KeyHash> m_Pipelines;
+	ShaderPipelineStats m_Stats;
+public:
+	ShaderPipeline& Get(const Shader* vertex, const Shader* fragment);
+	ShaderPipeline& Get(const Shader* const stages[PipelineStageCount]); // By ShaderStage, nullptr for stages to leave out
+
+	void Evict(const Shader& stage); // Deletes every pipeline using it
+	void Clear();
+
+	inline unsigned int GetCount() const { return (unsigned int)m_Pipelines.size(); }
+	inline const ShaderPipelineStats& GetStats() const { return m_Stats; }
+};
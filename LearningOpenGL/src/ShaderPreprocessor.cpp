@@ -0,0 +1,175 @@
+#include "ShaderPreprocessor.h"
+
+#include "Shader.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <set>
+
+static const unsigned int s_MaxIncludeDepth = 16;
+
+static std::string Directory(const std::string& filepath)
+{
+    size_t slash = filepath.find_last_of("/\\");
+    return slash == std::string::npos ? std::string() : filepath.substr(0, slash + 1);
+}
+
+static const char* SkipSpaces(const char* begin, const char* end)
+{
+    while (begin < end && (*begin == ' ' || *begin == '\t'))
+        begin++;
+    return begin;
+}
+
+static bool ParseDirective(const char* begin, const char* end, const char* name, size_t length, const char*& rest)
+{
+    begin = SkipSpaces(begin, end);
+    if ((size_t)(end - begin) < length || std::memcmp(begin, name, length) != 0)
+        return false;
+    rest = begin + length;
+    return true;
+}
+
+static bool ParseInclude(const char* begin, const char* end, std::string& path)
+{
+    const char* rest;
+    if (!ParseDirective(begin, end, "#include", 8, rest))
+        return false;
+
+    const char* open = (const char*)std::memchr(rest, '"', end - rest);
+    const char* close = open ? (const char*)std::memchr(open + 1, '"', end - open - 1) : nullptr;
+    if (!close)
+        return false;
+
+    path.assign(open + 1, close);
+    return true;
+}
+
+static unsigned int FileIndex(std::vector<std::string>& files, const std::string& filepath)
+{
+    for (unsigned int i = 0; i < files.size(); i++)
+    {
+        if (files[i] == filepath)
+            return i;
+    }
+    files.push_back(filepath);
+    return (unsigned int)files.size() - 1;
+}
+
+// Every pasted file is wrapped in #line directives, "#line 1 <file>" before and "#line <next line> <parent>" after,
+// so compile errors keep pointing at the right line of the right file
+static void AppendWithIncludes(std::string& out, const char* begin, const char* end, const std::string& filepath, unsigned int fileIndex,
+                               std::vector<std::string>& files, std::set<std::string>& included, unsigned int depth)
+{
+    std::string path;
+    unsigned int line = 1;
+    for (const char* p = begin; p < end;)
+    {
+        const char* eol = (const char*)std::memchr(p, '\n', end - p);
+        const char* next = eol ? eol + 1 : end;
+
+        const char* rest;
+        if (ParseDirective(p, next, "#line", 5, rest)) // Set by Shader::ParseShader, the next line is numbered N
+        {
+            line = (unsigned int)std::strtoul(rest, nullptr, 10);
+            out.append(p, next);
+            p = next;
+            continue;
+        }
+
+        if (!ParseInclude(p, next, path))
+        {
+            out.append(p, next);
+            if (!eol)
+                out += '\n';
+            line++;
+            p = next;
+            continue;
+        }
+
+        std::string fullPath = Directory(filepath) + path;
+        std::string contents;
+        if (!included.insert(fullPath).second)
+        {
+            out += "// #include \"" + path + "\" already included\n"; // Keeps the line count
+        }
+        else if (depth >= s_MaxIncludeDepth || !ShaderPreprocessor::ReadFile(fullPath, contents))
+        {
+            std::cout << "Failed to include '" << fullPath << "' from '" << filepath << "' line " << line << std::endl;
+            out += "// #include \"" + path + "\" failed\n";
+        }
+        else
+        {
+            out += "#line 1 " + std::to_string(FileIndex(files, fullPath)) + "\n";
+            AppendWithIncludes(out, contents.data(), contents.data() + contents.size(), fullPath, FileIndex(files, fullPath), files, included, depth + 1);
+            out += "#line " + std::to_string(line + 1) + " " + std::to_string(fileIndex) + "\n";
+        }
+        line++;
+        p = next;
+    }
+}
+
+bool ShaderPreprocessor::ReadFile(const std::string& filepath, std::string& contents)
+{
+    std::ifstream file(filepath, std::ios::binary | std::ios::ate); // Opened at the end to get the size
+    if (!file)
+        return false;
+
+    std::streamoff size = file.tellg();
+    contents.resize(size > 0 ? (size_t)size : 0);
+    file.seekg(0);
+    return contents.empty() || file.read(&contents[0], size).good();
+}
+
+std::string ShaderPreprocessor::ResolveIncludes(const std::string& source, const std::string& filepath, std::vector<std::string>& files)
+{
+    if (source.find("#include") == std::string::npos)
+        return source;
+
+    std::string out;
+    out.reserve(source.size() * 2);
+    std::set<std::string> included;
+    AppendWithIncludes(out, source.data(), source.data() + source.size(), filepath, FileIndex(files, filepath), files, included, 0);
+    return out;
+}
+
+std::string ShaderPreprocessor::InjectDefines(const std::string& source, const std::vector<std::string>& defines)
+{
+    if (defines.empty() || source.empty())
+        return source;
+
+    std::string block;
+    for (const std::string& define : defines)
+        block += "#define " + define + "\n";
+
+    // #version has to stay the first thing in the shader, the #line that follows it renumbers from there
+    size_t version = source.find("#version");
+    size_t insert = version == std::string::npos ? 0 : source.find('\n', version);
+    if (insert == std::string::npos)
+        return source + "\n" + block;
+    if (version != std::string::npos)
+        insert++;
+
+    return source.substr(0, insert) + block + source.substr(insert);
+}
+
+ShaderProgramSource ShaderPreprocessor::InjectDefines(const ShaderProgramSource& source, const std::vector<std::string>& defines)
+{
+    ShaderProgramSource result = source;
+    for (std::string& stage : result.Stages)
+        stage = InjectDefines(stage, defines);
+    return result;
+}
+
+std::string ShaderPreprocessor::VariantName(const std::string& filepath, const std::vector<std::string>& defines)
+{
+    if (defines.empty())
+        return filepath;
+
+    std::string name = filepath + "[";
+    for (size_t i = 0; i < defines.size(); i++)
+        name += (i ? "," : "") + defines[i];
+    return name + "]";
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+struct ShaderProgramSource;
+
+/*
+Source-level preprocessing done before GLSL ever sees a shader:
+
+    #include "path"  replaced by that file, relative to the including file. Each file is pasted at most
+                     once per stage, so shared blocks can be included from several places. #line directives
+                     keep compile errors pointing at the included file
+    defines          "NAME" or "NAME VALUE" strings, inserted as #define lines right after #version
+
+Variant names give each permutation of a file its own ShaderCache entry, e.g. "res/shaders/Object.shader[TEXTURED]".
+*/
+class ShaderPreprocessor
+{
+private:
+	ShaderPreprocessor() {} // Static only
+public:
+	static bool ReadFile(const std::string& filepath, std::string& contents); // Whole file in one read
+
+	// Included files are appended to 'files' (once, shared between stages) and referenced by index in #line directives
+	static std::string ResolveIncludes(const std::string& source, const std::string& filepath, std::vector<std::string>& files);
+	static std::string InjectDefines(const std::string& source, const std::vector<std::string>& defines);
+	static ShaderProgramSource InjectDefines(const ShaderProgramSource& source, const std::vector<std::string>& defines);
+
+	static std::string VariantName(const std::string& filepath, const std::vector<std::string>& defines);
+};
@@ -0,0 +1,465 @@
+#include "ShaderSpirv.h"
+
+#include "CPUProfiler.h"
+#include "ShaderPreprocessor.h"
+#include "UniformBlocks.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <unordered_map>
+
+static bool s_Enabled = false;
+static std::string s_Directory;
+
+static const char* s_StageExtensions[] = { "vert", "tesc", "tese", "geom", "frag", "comp" }; // What glslangValidator picks the stage by
+
+// The few parts of the SPIR-V spec needed for reflection
+static const uint32_t s_SpirvMagic = 0x07230203;
+
+enum SpirvOp : uint32_t
+{
+    OpName = 5, OpEntryPoint = 15, OpTypeBool = 20, OpTypeInt = 21, OpTypeFloat = 22, OpTypeVector = 23,
+    OpTypeMatrix = 24, OpTypeImage = 25, OpTypeSampledImage = 27, OpTypeArray = 28, OpTypeStruct = 30,
+    OpTypePointer = 32, OpConstant = 43, OpSpecConstantTrue = 48, OpSpecConstantFalse = 49, OpSpecConstant = 50,
+    OpVariable = 59, OpDecorate = 71
+};
+
+enum SpirvDecoration : uint32_t
+{
+    DecorationSpecId = 1, DecorationBlock = 2, DecorationLocation = 30, DecorationBinding = 33
+};
+
+enum SpirvStorageClass : uint32_t
+{
+    StorageUniformConstant = 0, StorageUniform = 2
+};
+
+struct SpirvInstruction // Result ids and operands of the declarations reflection looks at, by result id
+{
+    uint32_t Op = 0;
+    uint32_t Operands[3] = {};
+};
+
+static std::string ReadString(const uint32_t* words, size_t count)
+{
+    const char* text = (const char*)words; // Nul terminated, padded to whole words
+    const char* end = (const char*)std::memchr(text, 0, count * 4);
+    return std::string(text, end ? end : text + count * 4);
+}
+
+static unsigned int GetGLType(const std::unordered_map<uint32_t, SpirvInstruction>& types, uint32_t id)
+{
+    auto it = types.find(id);
+    if (it == types.end())
+        return 0;
+
+    const SpirvInstruction& type = it->second;
+    switch (type.Op)
+    {
+    case OpTypeBool:
+        return GL_BOOL;
+    case OpTypeInt:
+        return type.Operands[1] ? GL_INT : GL_UNSIGNED_INT; // Signedness
+    case OpTypeFloat:
+        return GL_FLOAT;
+    case OpTypeVector:
+    {
+        unsigned int offset = type.Operands[1] - 2; // vec2, vec3 and vec4 enums are consecutive
+        switch (GetGLType(types, type.Operands[0]))
+        {
+        case GL_FLOAT: return GL_FLOAT_VEC2 + offset;
+        case GL_INT: return GL_INT_VEC2 + offset;
+        case GL_UNSIGNED_INT: return GL_UNSIGNED_INT_VEC2 + offset;
+        case GL_BOOL: return GL_BOOL_VEC2 + offset;
+        default: return 0;
+        }
+    }
+    case OpTypeMatrix:
+    {
+        unsigned int columns = type.Operands[1];
+        unsigned int column = GetGLType(types, type.Operands[0]);
+        if (column < GL_FLOAT_VEC2 || column > GL_FLOAT_VEC4 || column - GL_FLOAT_VEC2 + 2 != columns)
+            return 0; // Square ones only
+        return GL_FLOAT_MAT2 + columns - 2;
+    }
+    case OpTypeSampledImage:
+    {
+        auto image = types.find(type.Operands[0]);
+        if (image == types.end())
+            return 0;
+        bool arrayed = image->second.Operands[2] != 0;
+        switch (image->second.Operands[1]) // Dim
+        {
+        case 0: return arrayed ? GL_SAMPLER_1D_ARRAY : GL_SAMPLER_1D;
+        case 1: return arrayed ? GL_SAMPLER_2D_ARRAY : GL_SAMPLER_2D;
+        case 2: return GL_SAMPLER_3D;
+        case 3: return arrayed ? GL_SAMPLER_CUBE_MAP_ARRAY : GL_SAMPLER_CUBE;
+        default: return 0;
+        }
+    }
+    case OpTypeImage: // Storage images, the sampled ones are wrapped in OpTypeSampledImage
+    {
+        bool arrayed = type.Operands[2] != 0;
+        switch (type.Operands[1])
+        {
+        case 1: return arrayed ? GL_IMAGE_2D_ARRAY : GL_IMAGE_2D;
+        case 2: return GL_IMAGE_3D;
+        case 3: return GL_IMAGE_CUBE;
+        default: return 0;
+        }
+    }
+    case OpTypeArray:
+        return GetGLType(types, type.Operands[0]);
+    default:
+        return 0;
+    }
+}
+
+bool SpirvModule::Parse()
+{
+    EntryPoint.clear();
+    Uniforms.clear();
+    Blocks.clear();
+    SpecConstants.clear();
+    if (Words.size() < 5 || Words[0] != s_SpirvMagic)
+        return false;
+
+    std::unordered_map<uint32_t, std::string> names;
+    std::unordered_map<uint32_t, uint32_t> locations, bindings, specIds, constants;
+    std::unordered_map<uint32_t, bool> blocks;
+    std::unordered_map<uint32_t, SpirvInstruction> types; // Types, pointers and spec constants
+    std::vector<SpirvInstruction> variables;
+
+    for (size_t i = 5; i < Words.size();)
+    {
+        uint32_t count = Words[i] >> 16;
+        uint32_t op = Words[i] & 0xFFFF;
+        if (count == 0 || i + count > Words.size())
+            return false;
+
+        const uint32_t* operands = &Words[i + 1];
+        switch (op)
+        {
+        case OpName:
+            names[operands[0]] = ReadString(operands + 1, count - 2);
+            break;
+        case OpEntryPoint:
+            if (EntryPoint.empty())
+                EntryPoint = ReadString(operands + 2, count - 3);
+            break;
+        case OpDecorate:
+            if (count < 3)
+                break;
+            if (operands[1] == DecorationBlock)
+                blocks[operands[0]] = true;
+            else if (count >= 4 && operands[1] == DecorationLocation)
+                locations[operands[0]] = operands[2];
+            else if (count >= 4 && operands[1] == DecorationBinding)
+                bindings[operands[0]] = operands[2];
+            else if (count >= 4 && operands[1] == DecorationSpecId)
+                specIds[operands[0]] = operands[2];
+            break;
+        case OpConstant:
+            constants[operands[1]] = operands[2]; // Array lengths
+            break;
+        case OpVariable:
+            variables.push_back({ op, { operands[0], operands[1], operands[2] } });
+            break;
+        case OpTypeBool: case OpTypeInt: case OpTypeFloat: case OpTypeVector: case OpTypeMatrix: case OpTypeImage:
+        case OpTypeSampledImage: case OpTypeArray: case OpTypeStruct: case OpTypePointer:
+        {
+            SpirvInstruction type;
+            type.Op = op;
+            for (uint32_t operand = 1; operand < count - 1 && operand <= 3; operand++)
+                type.Operands[operand - 1] = operands[operand];
+            if (op == OpTypeImage) // Keep Dim and Arrayed, skip the sampled type and depth
+            {
+                type.Operands[1] = operands[2];
+                type.Operands[2] = operands[4];
+            }
+            types[operands[0]] = type;
+            break;
+        }
+        case OpSpecConstantTrue: case OpSpecConstantFalse: case OpSpecConstant:
+            types[operands[1]] = { op, { operands[0] } };
+            break;
+        default:
+            break;
+        }
+        i += count;
+    }
+
+    for (auto& spec : specIds)
+    {
+        auto constant = types.find(spec.first);
+        if (constant == types.end())
+            continue;
+        unsigned int type = GetGLType(types, constant->second.Operands[0]);
+        SpecConstants.push_back({ names[spec.first], spec.second, type });
+    }
+
+    for (const SpirvInstruction& variable : variables)
+    {
+        uint32_t id = variable.Operands[1];
+        uint32_t storage = variable.Operands[2];
+        auto pointer = types.find(variable.Operands[0]);
+        if (pointer == types.end() || pointer->second.Op != OpTypePointer)
+            continue;
+        uint32_t pointee = pointer->second.Operands[1];
+
+        if (storage == StorageUniformConstant) // Default block uniforms and samplers
+        {
+            UniformInfo uniform;
+            uniform.Name = names[id];
+            auto location = locations.find(id);
+            uniform.Location = location == locations.end() ? -1 : (int)location->second;
+            uniform.Type = GetGLType(types, pointee);
+            uniform.Size = 1;
+            auto type = types.find(pointee);
+            if (type != types.end() && type->second.Op == OpTypeArray)
+                uniform.Size = (int)constants[type->second.Operands[1]];
+            Uniforms.push_back(uniform);
+        }
+        else if (storage == StorageUniform && blocks.count(pointee) && bindings.count(id)) // Uniform blocks, storage blocks are BufferBlock
+        {
+            Blocks.push_back({ names[pointee], bindings[id] });
+        }
+    }
+    return true;
+}
+
+bool ShaderSpirv::Init(const std::string& directory)
+{
+    if (!GLEW_VERSION_4_6 && !GLEW_ARB_gl_spirv)
+    {
+        std::cout << "SPIR-V shaders need GL 4.6 or ARB_gl_spirv, compiling GLSL instead" << std::endl;
+        return false;
+    }
+
+    s_Directory = directory;
+    s_Enabled = true;
+    return true;
+}
+
+void ShaderSpirv::Shutdown()
+{
+    s_Enabled = false;
+    s_Directory.clear();
+}
+
+bool ShaderSpirv::IsEnabled()
+{
+    return s_Enabled;
+}
+
+std::string ShaderSpirv::GetModuleName(const std::string& filepath, ShaderStage stage)
+{
+    size_t slash = filepath.find_last_of("/\\");
+    size_t start = slash == std::string::npos ? 0 : slash + 1;
+    size_t dot = filepath.find('.', start);
+    return filepath.substr(start, dot == std::string::npos ? std::string::npos : dot - start) + "." + s_StageExtensions[(unsigned int)stage];
+}
+
+static bool ReadModule(const std::string& path, SpirvModule& module)
+{
+    std::string contents;
+    if (!ShaderPreprocessor::ReadFile(path, contents))
+        return false;
+
+    module.Words.resize(contents.size() / 4);
+    std::memcpy(module.Words.data(), contents.data(), module.Words.size() * 4);
+    return true;
+}
+
+// A define "NAME" or "NAME VALUE" as a value for the constant's type, 1 / true when there is no value
+static uint32_t ParseSpecValue(const std::string& value, unsigned int type)
+{
+    if (type == GL_FLOAT)
+    {
+        float number = value.empty() ? 1.0f : std::strtof(value.c_str(), nullptr);
+        uint32_t bits;
+        std::memcpy(&bits, &number, sizeof(bits));
+        return bits;
+    }
+    long number = value.empty() ? 1 : std::strtol(value.c_str(), nullptr, 0);
+    return type == GL_BOOL ? (number != 0) : (uint32_t)number;
+}
+
+// GL only knows the bindings the modules gave each block, move the shared blocks to their UniformBinding
+static void BindUniformBlocks(unsigned int program, const SpirvModule* modules, const std::string& filepath)
+{
+    int blockCount = 0;
+    GLCall(glGetProgramiv(program, GL_ACTIVE_UNIFORM_BLOCKS, &blockCount));
+    std::vector<int> bindings(blockCount);
+    for (int i = 0; i < blockCount; i++) // All of them first, rebinding one could make it look like another
+    {
+        GLCall(glGetActiveUniformBlockiv(program, i, GL_UNIFORM_BLOCK_BINDING, &bindings[i]));
+    }
+
+    for (int i = 0; i < blockCount; i++)
+    {
+        const char* name = nullptr;
+        for (unsigned int stage = 0; stage < (unsigned int)ShaderStage::Count && !name; stage++)
+        {
+            for (const SpirvBlock& block : modules[stage].Blocks)
+            {
+                if (block.Binding == (unsigned int)bindings[i])
+                    name = block.Name.c_str();
+            }
+        }
+
+        const UniformBlockInfo* block = name ? FindUniformBlock(name) : nullptr;
+        if (!block)
+        {
+            std::cout << "Warning : Uniform block at binding " << bindings[i] << " in '" << filepath << "' has no binding point!" << std::endl;
+            continue;
+        }
+
+        int dataSize = 0;
+        GLCall(glGetActiveUniformBlockiv(program, i, GL_UNIFORM_BLOCK_DATA_SIZE, &dataSize));
+        if ((unsigned int)dataSize != block->Size)
+            std::cout << "Warning : Uniform block '" << block->Name << "' is " << dataSize << " bytes in '" << filepath << "' but " << block->Size << " in C++!" << std::endl;
+
+        GLCall(glUniformBlockBinding(program, i, (unsigned int)block->Binding));
+    }
+}
+
+SpirvProgram ShaderSpirv::Load(const std::string& filepath, const std::vector<std::string>& defines)
+{
+    SpirvProgram result;
+    if (!s_Enabled)
+        return result;
+
+    PROFILE_FUNCTION();
+    SpirvModule modules[(unsigned int)ShaderStage::Count];
+    std::string paths[(unsigned int)ShaderStage::Count];
+    bool found = false;
+    for (unsigned int i = 0; i < (unsigned int)ShaderStage::Count; i++)
+    {
+        paths[i] = s_Directory + "/" + GetModuleName(filepath, (ShaderStage)i) + ".spv";
+        if (!ReadModule(paths[i], modules[i]))
+            continue;
+
+        if (!modules[i].Parse())
+        {
+            std::cout << "'" << paths[i] << "' is not a SPIR-V module, compiling '" << filepath << "' from GLSL" << std::endl;
+            return result;
+        }
+        found = true;
+    }
+    if (!found)
+        return result;
+
+    std::vector<unsigned int> specIds[(unsigned int)ShaderStage::Count];
+    std::vector<unsigned int> specValues[(unsigned int)ShaderStage::Count];
+    for (const std::string& define : defines)
+    {
+        size_t space = define.find(' ');
+        std::string name = define.substr(0, space);
+        std::string value = space == std::string::npos ? std::string() : define.substr(space + 1);
+
+        bool matched = false;
+        for (unsigned int i = 0; i < (unsigned int)ShaderStage::Count; i++)
+        {
+            for (const SpirvSpecConstant& constant : modules[i].SpecConstants)
+            {
+                if (constant.Name != name)
+                    continue;
+                specIds[i].push_back(constant.ID);
+                specValues[i].push_back(ParseSpecValue(value, constant.Type));
+                matched = true;
+            }
+        }
+        if (!matched)
+        {
+            std::cout << "No specialization constant for '" << name << "' in the SPIR-V of '" << filepath << "', compiling GLSL" << std::endl;
+            return result;
+        }
+    }
+
+    unsigned int shaders[(unsigned int)ShaderStage::Count] = {};
+    bool failed = false;
+    for (unsigned int i = 0; i < (unsigned int)ShaderStage::Count && !failed; i++)
+    {
+        if (modules[i].Words.empty())
+            continue;
+
+        GLCall(shaders[i] = glCreateShader(Shader::GetStageType((ShaderStage)i)));
+        GLCall(glShaderBinary(1, &shaders[i], GL_SHADER_BINARY_FORMAT_SPIR_V_ARB, modules[i].Words.data(), (GLsizei)(modules[i].Words.size() * 4)));
+        const char* entryPoint = modules[i].EntryPoint.empty() ? "main" : modules[i].EntryPoint.c_str();
+        GLsizei count = (GLsizei)specIds[i].size();
+        if (GLEW_VERSION_4_6)
+        {
+            GLCall(glSpecializeShader(shaders[i], entryPoint, count, specIds[i].data(), specValues[i].data()));
+        }
+        else
+        {
+            GLCall(glSpecializeShaderARB(shaders[i], entryPoint, count, specIds[i].data(), specValues[i].data()));
+        }
+        failed = !Shader::CheckCompileStatus(shaders[i], (ShaderStage)i, { paths[i] }); // Specializing is the compile step
+    }
+
+    unsigned int program = 0;
+    if (!failed)
+    {
+        GLCall(program = glCreateProgram());
+        for (unsigned int shader : shaders)
+        {
+            if (shader)
+            {
+                GLCall(glAttachShader(program, shader));
+            }
+        }
+        GLCall(glLinkProgram(program));
+    }
+    for (unsigned int shader : shaders)
+    {
+        GLCall(glDeleteShader(shader));
+    }
+
+    if (failed || !Shader::CheckLinkStatus(program, filepath))
+    {
+        GLCall(glDeleteProgram(program));
+        std::cout << "Compiling '" << filepath << "' from GLSL instead" << std::endl;
+        return result;
+    }
+
+    BindUniformBlocks(program, modules, filepath);
+
+    for (const SpirvModule& module : modules) // Stages can share a uniform, it only goes in once
+    {
+        for (const UniformInfo& uniform : module.Uniforms)
+        {
+            bool duplicate = false;
+            for (const UniformInfo& existing : result.Uniforms)
+                duplicate |= existing.Name == uniform.Name;
+            if (!duplicate)
+                result.Uniforms.push_back(uniform);
+        }
+    }
+    result.Program = program;
+    return result;
+}
+
+bool ShaderSpirv::ExportGLSL(const std::string& filepath, const std::string& directory)
+{
+    ShaderProgramSource source = Shader::ParseShader(filepath);
+    bool exported = false;
+    for (unsigned int i = 0; i < (unsigned int)ShaderStage::Count; i++)
+    {
+        if (!source.Has((ShaderStage)i))
+            continue;
+
+        std::string path = directory + "/" + GetModuleName(filepath, (ShaderStage)i);
+        std::ofstream file(path, std::ios::binary);
+        if (!file.write(source.Stages[i].data(), source.Stages[i].size()))
+        {
+            std::cout << "Failed to write '" << path << "'" << std::endl;
+            return false;
+        }
+        exported = true;
+    }
+    return exported;
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include "GLPrerequisites.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "Shader.h"
+
+struct SpirvSpecConstant
+{
+	std::string Name;
+	unsigned int ID; // layout(constant_id = ID)
+	unsigned int Type; // GL_BOOL, GL_INT, GL_UNSIGNED_INT or GL_FLOAT
+};
+
+struct SpirvBlock // Uniform block, by type name
+{
+	std::string Name;
+	unsigned int Binding;
+};
+
+/*
+What a SPIR-V module says about itself, read from its OpName / OpDecorate debug info. GL keeps no uniform
+names for SPIR-V programs, so this is where reflection comes from. Modules stripped of debug info load
+fine but have no names to look anything up by.
+*/
+struct SpirvModule
+{
+	std::vector<uint32_t> Words;
+	std::string EntryPoint;
+	std::vector<UniformInfo> Uniforms; // Default block uniforms, Location -1 if the module gave them none
+	std::vector<SpirvBlock> Blocks;
+	std::vector<SpirvSpecConstant> SpecConstants;
+
+	bool Parse(); // Fills everything from Words, false if they aren't a SPIR-V module
+};
+
+struct SpirvProgram
+{
+	unsigned int Program = 0; // 0 if there are no modules for the file, compile the GLSL instead
+	std::vector<UniformInfo> Uniforms;
+};
+
+/*
+Loads programs from SPIR-V modules compiled at build time (GL 4.6 / ARB_gl_spirv), skipping the driver's
+GLSL compiler. The CompileSpirv build target exports each stage of every .shader file in res/shaders with
+its #includes resolved ("--export-glsl") and compiles it with glslangValidator into
+
+    <directory>/<name>.<vert|tesc|tese|geom|frag|comp>.spv
+
+Variants are specialization constants rather than #defines: a define "NAME" or "NAME VALUE" sets the
+constant with OpName NAME (declared "layout(constant_id = N) const bool NAME" under #ifdef GL_SPIRV). A
+define the modules have no constant for can't be done this way, so that variant compiles from GLSL.
+
+Without the extension, or without modules for a file, Load returns no program and the GLSL path is used.
+*/
+class ShaderSpirv
+{
+private:
+	ShaderSpirv() {} // Static only
+public:
+	static bool Init(const std::string& directory); // After the context is current
+	static void Shutdown();
+	static bool IsEnabled();
+
+	static SpirvProgram Load(const std::string& filepath, const std::vector<std::string>& defines = {});
+
+	// Writes each stage of 'filepath' as <directory>/<name>.<stage extension>, ready for glslangValidator
+	static bool ExportGLSL(const std::string& filepath, const std::string& directory);
+	static std::string GetModuleName(const std::string& filepath, ShaderStage stage); // "Object.frag" for res/shaders/Object.shader
+};
@@ -0,0 +1,62 @@
+#include "ShaderStorageBuffer.h"
+
+#include "GLState.h"
+
+ShaderStorageBuffer::ShaderStorageBuffer(unsigned int size, const void* data, unsigned int usage)
+    : m_RendererID(0), m_Size(size), m_Usage(usage)
+{
+    GLCall(glGenBuffers(1, &m_RendererID));
+    Bind();
+    GLCall(glBufferData(GL_SHADER_STORAGE_BUFFER, size, data, usage));
+}
+
+ShaderStorageBuffer::~ShaderStorageBuffer()
+{
+    GLCall(glDeleteBuffers(1, &m_RendererID));
+    GLState::OnBufferDeleted(m_RendererID);
+}
+
+void ShaderStorageBuffer::Bind() const
+{
+    GLState::BindBuffer(GL_SHADER_STORAGE_BUFFER, m_RendererID);
+}
+
+void ShaderStorageBuffer::BindBase(unsigned int index) const
+{
+    GLState::BindBufferBase(GL_SHADER_STORAGE_BUFFER, index, m_RendererID);
+}
+
+void ShaderStorageBuffer::BindRange(unsigned int index, unsigned int offset, unsigned int size) const
+{
+    GLState::BindBufferRange(GL_SHADER_STORAGE_BUFFER, index, m_RendererID, offset, size);
+}
+
+void ShaderStorageBuffer::BindAs(unsigned int target) const
+{
+    GLState::BindBuffer(target, m_RendererID);
+}
+
+void ShaderStorageBuffer::SetData(const void* data, unsigned int size, unsigned int offset)
+{
+    Bind();
+    if (offset == 0 && size == m_Size)
+    {
+        GLCall(glBufferData(GL_SHADER_STORAGE_BUFFER, size, data, m_Usage)); // Orphans, no waiting on a dispatch still reading it
+    }
+    else
+    {
+        GLCall(glBufferSubData(GL_SHADER_STORAGE_BUFFER, offset, size, data));
+    }
+}
+
+void ShaderStorageBuffer::GetData(void* data, unsigned int size, unsigned int offset) const
+{
+    Bind();
+    GLCall(glGetBufferSubData(GL_SHADER_STORAGE_BUFFER, offset, size, data)); // Needs a GL_BUFFER_UPDATE_BARRIER_BIT after the writing dispatch
+}
+
+void ShaderStorageBuffer::Clear()
+{
+    Bind();
+    GLCall(glClearBufferData(GL_SHADER_STORAGE_BUFFER, GL_R32UI, GL_RED_INTEGER, GL_UNSIGNED_INT, nullptr));
+}
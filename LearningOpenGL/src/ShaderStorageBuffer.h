@@ -0,0 +1,32 @@
+#pragma once
+
+#include "GLPrerequisites.h"
+
+/*
+Read-write buffer for compute shaders ("buffer" blocks in GLSL, GL 4.3 / ARB_shader_storage_buffer_object).
+Unlike a UniformBuffer it can hold runtime-sized arrays as big as the GPU allows, and the same storage can
+be bound as vertex or indirect arguments afterwards with BindAs, no copy needed. Put a
+ComputeShader::Barrier between the pass that writes it and whatever reads it.
+*/
+class ShaderStorageBuffer
+{
+private:
+	unsigned int m_RendererID;
+	unsigned int m_Size;
+	unsigned int m_Usage;
+public:
+	ShaderStorageBuffer(unsigned int size, const void* data = nullptr, unsigned int usage = GL_DYNAMIC_COPY); // Filled and read by the GPU by default
+	~ShaderStorageBuffer();
+
+	void Bind() const;
+	void BindBase(unsigned int index) const; // layout(std430, binding = index)
+	void BindRange(unsigned int index, unsigned int offset, unsigned int size) const; // 'offset' must be a multiple of GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT
+	void BindAs(unsigned int target) const; // GL_ARRAY_BUFFER, GL_DRAW_INDIRECT_BUFFER, GL_DISPATCH_INDIRECT_BUFFER...
+
+	void SetData(const void* data, unsigned int size, unsigned int offset = 0);
+	void GetData(void* data, unsigned int size, unsigned int offset = 0) const; // Waits for the GPU, for tools and tests rather than every frame
+	void Clear(); // Zero fill on the GPU, the size has to be a multiple of 4
+
+	inline unsigned int GetRendererID() const { return m_RendererID; }
+	inline unsigned int GetSize() const { return m_Size; }
+};
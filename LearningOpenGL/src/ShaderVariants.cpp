@@ -0,0 +1,61 @@
+#include "ShaderVariants.h"
+
+#include "ShaderPreprocessor.h"
+#include "ShaderSpirv.h"
+
+ShaderVariants::ShaderVariants(const std::string& filepath, const std::vector<std::string>& features)
+    : m_FilePath(filepath), m_Features(features), m_Source(Shader::ParseShader(filepath))
+{
+    ASSERT(features.size() <= MaxFeatures);
+}
+
+Shader& ShaderVariants::Get(uint32_t key)
+{
+    auto it = m_Variants.find(key);
+    if (it != m_Variants.end())
+        return *it->second;
+
+    std::vector<std::string> defines = GetDefines(key);
+    std::string name = ShaderPreprocessor::VariantName(m_FilePath, defines);
+    SpirvProgram spirv = ShaderSpirv::Load(m_FilePath, defines); // Same modules for every variant, the features are specialization constants
+    std::unique_ptr<Shader> shader = spirv.Program != 0 ? std::make_unique<Shader>(name, spirv.Program, spirv.Uniforms)
+                                                        : std::make_unique<Shader>(name, ShaderPreprocessor::InjectDefines(m_Source, defines));
+    Shader& result = *shader;
+    m_Variants.emplace(key, std::move(shader));
+    return result;
+}
+
+Shader& ShaderVariants::GetStage(uint32_t key, ShaderStage stage)
+{
+    uint64_t stageKey = ((uint64_t)key << 32) | (uint64_t)stage;
+    auto it = m_Stages.find(stageKey);
+    if (it != m_Stages.end())
+        return *it->second;
+
+    std::vector<std::string> defines = GetDefines(key);
+    std::unique_ptr<Shader> shader = std::make_unique<Shader>(ShaderPreprocessor::VariantName(m_FilePath, defines), ShaderPreprocessor::InjectDefines(m_Source, defines), stage);
+    Shader& result = *shader;
+    m_Stages.emplace(stageKey, std::move(shader));
+    return result;
+}
+
+uint32_t ShaderVariants::GetFeatureBit(const std::string& feature) const
+{
+    for (size_t i = 0; i < m_Features.size(); i++)
+    {
+        if (m_Features[i] == feature)
+            return 1u << i;
+    }
+    return 0;
+}
+
+std::vector<std::string> ShaderVariants::GetDefines(uint32_t key) const
+{
+    std::vector<std::string> defines;
+    for (size_t i = 0; i < m_Features.size(); i++)
+    {
+        if (key & (1u << i))
+            defines.push_back(m_Features[i]);
+    }
+    return defines;
+}
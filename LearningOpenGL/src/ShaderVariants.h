@@ -0,0 +1,46 @@
+#pragma once
+
+#include "GLPrerequisites.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "Shader.h"
+
+/*
+One .shader file compiled into as many variants as there are feature combinations actually used.
+Feature i is bit i of the key and becomes "#define <feature>" in that variant, so the GLSL picks
+paths with #ifdef instead of branching at runtime (SPIR-V variants set specialization constants instead,
+see ShaderSpirv). A variant is compiled the first time its key is asked for and kept until the
+ShaderVariants goes away.
+
+    ShaderVariants objects("res/shaders/Object.shader", { "TEXTURED", "VERTEX_COLOR" });
+    Shader& shader = objects.Get(objects.GetFeatureBit("TEXTURED"));
+
+GetStage builds one stage of a variant as a separable program for a ShaderPipeline instead. A feature only
+the fragment stage looks at then costs another fragment program, the vertex one is shared.
+*/
+class ShaderVariants
+{
+public:
+	static const unsigned int MaxFeatures = 32;
+private:
+	std::string m_FilePath;
+	std::vector<std::string> m_Features;
+	ShaderProgramSource m_Source; // Read and include-resolved once, shared by every variant
+	std::unordered_map<uint32_t, std::unique_ptr<Shader>> m_Variants;
+	std::unordered_map<uint64_t, std::unique_ptr<Shader>> m_Stages; // Key in the high half, ShaderStage in the low
+public:
+	ShaderVariants(const std::string& filepath, const std::vector<std::string>& features);
+
+	Shader& Get(uint32_t key);
+	Shader& GetStage(uint32_t key, ShaderStage stage); // Needs ShaderPipeline::IsSupported(), no SPIR-V
+	uint32_t GetFeatureBit(const std::string& feature) const; // 0 if the feature isn't known
+
+	std::vector<std::string> GetDefines(uint32_t key) const;
+	inline unsigned int GetCompiledCount() const { return (unsigned int)(m_Variants.size() + m_Stages.size()); }
+	inline const std::string& GetFilePath() const { return m_FilePath; }
+};
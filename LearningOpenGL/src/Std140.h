@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstddef>
+
+#include "glm.hpp"
+
+/*
+Compile-time checks that a C++ struct has the same layout as the std140 GLSL block it mirrors.
+List every member, padding included:
+
+    struct CameraBlock { glm::mat4 ViewProjection; glm::vec3 Position; float Time; };
+    STD140_MEMBER(CameraBlock, ViewProjection);
+    STD140_MEMBER(CameraBlock, Position);
+    STD140_MEMBER(CameraBlock, Time);
+    STD140_SIZE(CameraBlock);
+
+glm types only need 4 byte alignment in C++, so members are packed back to back and a member is in the
+right place as long as its offset is a multiple of its std140 base alignment. Types without a std140
+equivalent of the same size (bool, mat3, arrays of scalars or vec2/vec3...) have no Std140Traits and
+fail to compile.
+*/
+template<typename T>
+struct Std140Traits;
+
+template<> struct Std140Traits<float>        { static const size_t Alignment = 4; };
+template<> struct Std140Traits<int>          { static const size_t Alignment = 4; };
+template<> struct Std140Traits<unsigned int> { static const size_t Alignment = 4; };
+template<> struct Std140Traits<glm::vec2>    { static const size_t Alignment = 8; };
+template<> struct Std140Traits<glm::ivec2>   { static const size_t Alignment = 8; };
+template<> struct Std140Traits<glm::vec3>    { static const size_t Alignment = 16; };
+template<> struct Std140Traits<glm::ivec3>   { static const size_t Alignment = 16; };
+template<> struct Std140Traits<glm::vec4>    { static const size_t Alignment = 16; };
+template<> struct Std140Traits<glm::ivec4>   { static const size_t Alignment = 16; };
+template<> struct Std140Traits<glm::mat4>    { static const size_t Alignment = 16; };
+
+template<typename T, size_t N>
+struct Std140Traits<T[N]>
+{
+	static_assert(Std140Traits<T>::Alignment == 16 && sizeof(T) % 16 == 0, "std140 pads array elements to 16 bytes, use vec4, ivec4 or mat4 arrays");
+	static const size_t Alignment = 16;
+};
+
+#define STD140_MEMBER(Struct, Member) \
+	static_assert(offsetof(Struct, Member) % Std140Traits<decltype(Struct::Member)>::Alignment == 0, #Struct "::" #Member " is not std140 aligned, add padding before it")
+#define STD140_SIZE(Struct) \
+	static_assert(sizeof(Struct) % 16 == 0, #Struct " must be padded to a multiple of 16 bytes")
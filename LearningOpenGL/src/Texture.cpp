@@ -2,22 +2,43 @@
 
 #include "stb_image.h"
 
+#include "CPUProfiler.h"
+#include "GLState.h"
+#include "TextureContainer.h"
+
+#include <algorithm>
+#include <iostream>
+
 Texture::Texture(const std::string& path)
 	: m_RendererID(0), m_FilePath(path), m_LocalBuffer(nullptr), m_Width(0), m_Height(0), m_BPP(0) // Initalise variables
 {
+	if (TextureContainer::IsContainer(path))
+	{
+		CompressedImage image;
+		TextureContainer::Load(path, image); // Prints why if it can't, the texture is then empty like a PNG that failed to decode
+		CreateCompressed(image);
+		return;
+	}
+
 	stbi_set_flip_vertically_on_load(1); // 1 acts as true
-	m_LocalBuffer = stbi_load(path.c_str(), &m_Width, &m_Height, &m_BPP, 4);
+	{
+		PROFILE_SCOPE("Texture Decode");
+		m_LocalBuffer = stbi_load(path.c_str(), &m_Width, &m_Height, &m_BPP, 4);
+	}
 
 	GLCall(glGenTextures(1, &m_RendererID));
-	GLCall(glBindTexture(GL_TEXTURE_2D, m_RendererID));
+	GLState::BindTexture(GL_TEXTURE_2D, m_RendererID);
 
 	GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR));
 	GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR));
 	GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE));
 	GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE)); // make sure to specifiy these 4 params
 
-	GLCall(glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, m_Width, m_Height, 0, GL_RGBA, GL_UNSIGNED_BYTE, m_LocalBuffer));
-	GLCall(glBindTexture(GL_TEXTURE_2D, 0));
+	{
+		PROFILE_SCOPE("Texture Upload");
+		GLCall(glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, m_Width, m_Height, 0, GL_RGBA, GL_UNSIGNED_BYTE, m_LocalBuffer));
+	}
+	GLState::BindTexture(GL_TEXTURE_2D, 0);
 
 	if (m_LocalBuffer)
 	{
@@ -25,18 +46,121 @@ Texture::Texture(const std::string& path)
 	}
 }
 
+Texture::Texture(int width, int height, const void* data)
+	: m_RendererID(0), m_FilePath(), m_LocalBuffer(nullptr), m_Width(width), m_Height(height), m_BPP(4)
+{
+	GLCall(glGenTextures(1, &m_RendererID));
+	GLState::BindTexture(GL_TEXTURE_2D, m_RendererID);
+
+	GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR));
+	GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR));
+	GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE));
+	GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE));
+
+	GLCall(glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, m_Width, m_Height, 0, GL_RGBA, GL_UNSIGNED_BYTE, data));
+	GLState::BindTexture(GL_TEXTURE_2D, 0);
+}
+
+Texture::Texture(int width, int height, int level, const void* data)
+	: m_RendererID(0), m_FilePath(), m_LocalBuffer(nullptr), m_Width(width), m_Height(height), m_BPP(4)
+{
+	GLCall(glGenTextures(1, &m_RendererID));
+	GLState::BindTexture(GL_TEXTURE_2D, m_RendererID);
+
+	GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR));
+	GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR));
+	GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE));
+	GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE));
+	GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, level)); // The finer levels don't exist, the texture is complete without them
+	GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, level));
+
+	GLCall(glTexImage2D(GL_TEXTURE_2D, level, GL_RGBA8, std::max(width >> level, 1), std::max(height >> level, 1), 0, GL_RGBA, GL_UNSIGNED_BYTE, data));
+	GLState::BindTexture(GL_TEXTURE_2D, 0);
+}
+
+Texture::Texture(int width, int height, const std::vector<std::vector<unsigned char>>& levels)
+	: m_RendererID(0), m_FilePath(), m_LocalBuffer(nullptr), m_Width(width), m_Height(height), m_BPP(4)
+{
+	GLCall(glGenTextures(1, &m_RendererID));
+	GLState::BindTexture(GL_TEXTURE_2D, m_RendererID);
+
+	GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, levels.size() > 1 ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR));
+	GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR));
+	GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE));
+	GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE));
+	GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, std::max((int)levels.size() - 1, 0)));
+
+	{
+		PROFILE_SCOPE("Texture Upload");
+		for (unsigned int level = 0; level < levels.size(); level++)
+		{
+			GLCall(glTexImage2D(GL_TEXTURE_2D, level, GL_RGBA8, std::max(width >> level, 1), std::max(height >> level, 1), 0, GL_RGBA, GL_UNSIGNED_BYTE, levels[level].data()));
+		}
+	}
+	GLState::BindTexture(GL_TEXTURE_2D, 0);
+}
+
+Texture::Texture(const CompressedImage& image)
+	: m_RendererID(0), m_FilePath(), m_LocalBuffer(nullptr), m_Width(0), m_Height(0), m_BPP(0)
+{
+	CreateCompressed(image);
+}
+
+void Texture::CreateCompressed(const CompressedImage& image)
+{
+	GLCall(glGenTextures(1, &m_RendererID));
+	GLState::BindTexture(GL_TEXTURE_2D, m_RendererID);
+
+	GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, image.Levels.size() > 1 ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR));
+	GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR));
+	GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE));
+	GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE));
+
+	if (!image.Levels.empty() && !TextureContainer::IsSupported(image.Format))
+		std::cout << "Texture '" << m_FilePath << "' is " << TextureContainer::GetName(image.Format) << ", which this context can't sample!" << std::endl;
+	else if (!image.Levels.empty())
+	{
+		m_Width = image.Width;
+		m_Height = image.Height;
+		GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, (int)image.Levels.size() - 1)); // A chain that stops short of 1x1 is still complete
+		PROFILE_SCOPE("Texture Upload");
+		for (unsigned int level = 0; level < image.Levels.size(); level++)
+		{
+			GLCall(glCompressedTexImage2D(GL_TEXTURE_2D, level, TextureContainer::GetInternalFormat(image.Format), std::max(m_Width >> level, 1), std::max(m_Height >> level, 1), 0, (int)image.Levels[level].size(), image.Levels[level].data()));
+		}
+	}
+	GLState::BindTexture(GL_TEXTURE_2D, 0);
+}
+
 Texture::~Texture()
 {
 	GLCall(glDeleteTextures(1, &m_RendererID));
+	GLState::OnTextureDeleted(m_RendererID);
 }
 
 void Texture::Bind(unsigned int slot) const
 {
-	GLCall(glActiveTexture(GL_TEXTURE0 + slot));
-	GLCall(glBindTexture(GL_TEXTURE_2D, m_RendererID));
+	GLState::BindTexture(slot, GL_TEXTURE_2D, m_RendererID); // Skips glActiveTexture too when already bound on that slot
+}
+
+void Texture::BindImage(unsigned int unit, unsigned int access) const
+{
+	GLCall(glBindImageTexture(unit, m_RendererID, 0, GL_FALSE, 0, access, GL_RGBA8)); // Image units are separate from texture units, GLState does not track them
 }
 
 void Texture::Unbind() const
 {
-	GLCall(glBindTexture(GL_TEXTURE_2D, 0));
+	GLState::BindTexture(GL_TEXTURE_2D, 0);
+}
+
+void Texture::GenerateMipmaps(int levels) const
+{
+	if (m_Width == 0)
+		return;
+
+	GLState::BindTexture(GL_TEXTURE_2D, m_RendererID);
+	GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, levels > 0 ? levels - 1 : 1000)); // 1000 is GL's default, the chain just stops at 1x1
+	GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR)); // Only used without a Sampler on the unit
+	GLCall(glGenerateMipmap(GL_TEXTURE_2D));
+	GLState::BindTexture(GL_TEXTURE_2D, 0);
 }
@@ -3,6 +3,9 @@
 #include "GLPrerequisites.h"
 
 #include <string>
+#include <vector>
+
+struct CompressedImage;
 
 class Texture
 {
@@ -12,12 +15,21 @@ private:
 	unsigned char* m_LocalBuffer;
 	int m_Width, m_Height, m_BPP;
 public:
-	Texture(const std::string& path);
+	Texture(const std::string& path); // .dds and .ktx2 files load compressed with their mips, see TextureContainer
+	Texture(int width, int height, const void* data); // RGBA8 texture from raw pixels
+	Texture(int width, int height, int level, const void* data); // Only mip 'level' given (width >> level wide), GL_TEXTURE_BASE_LEVEL clamps sampling to it. See TextureStreamer
+	Texture(const CompressedImage& image); // Every level with glCompressedTexImage2D, left empty if the context can't sample the format
+	Texture(int width, int height, const std::vector<std::vector<unsigned char>>& levels); // RGBA8 mips baked on the CPU, see MipChain
 	~Texture();
 
 	void Bind(unsigned int slot = 0) const; // windows roughly 32 tex slots, mobile more like 8
+	void BindImage(unsigned int unit, unsigned int access = GL_READ_WRITE) const; // Level 0 as a layout(rgba8) image2D for compute shaders, GL 4.2+
 	void Unbind() const;
+	void GenerateMipmaps(int levels = 0) const; // glGenerateMipmap down to 'levels' (0 for 1x1) and trilinear filtering. Not for compressed textures
 
+	inline unsigned int GetRendererID() const { return m_RendererID; }
 	inline int GetWidth() const { return m_Width; }
 	inline int GetHeight() const { return m_Height; }
+private:
+	void CreateCompressed(const CompressedImage& image);
 };
\ No newline at end of file
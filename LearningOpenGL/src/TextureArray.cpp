@@ -0,0 +1,160 @@
+#include "TextureArray.h"
+
+#include "stb_image.h"
+
+#include "CPUProfiler.h"
+#include "GLState.h"
+#include "MipChain.h"
+
+#include <algorithm>
+#include <iostream>
+
+TextureArray::TextureArray(int width, int height, unsigned int layerCount, int mipLevels)
+	: m_RendererID(0), m_Width(width), m_Height(height), m_LayerCount(layerCount), m_MipLevels(mipLevels)
+{
+	Create();
+}
+
+TextureArray::TextureArray(const std::vector<std::string>& paths, int mipLevels)
+	: m_RendererID(0), m_Width(0), m_Height(0), m_LayerCount((unsigned int)paths.size()), m_MipLevels(mipLevels)
+{
+	PROFILE_FUNCTION();
+	ASSERT(!paths.empty());
+
+	int bpp = 0;
+	stbi_info(paths[0].c_str(), &m_Width, &m_Height, &bpp); // Header only, the pixels are read by LoadLayer
+	if (m_Width == 0 || m_Height == 0)
+	{
+		std::cout << "Failed to load '" << paths[0] << "' for a texture array!" << std::endl;
+		m_Width = m_Height = 1;
+	}
+	Create();
+
+	for (unsigned int layer = 0; layer < m_LayerCount; layer++)
+		LoadLayer(layer, paths[layer]);
+	GenerateMipmaps();
+}
+
+TextureArray::~TextureArray()
+{
+	GLCall(glDeleteTextures(1, &m_RendererID));
+	GLState::OnTextureDeleted(m_RendererID);
+}
+
+void TextureArray::Create()
+{
+	ASSERT(m_LayerCount > 0 && (int)m_LayerCount <= GetMaxLayers());
+	int fullChain = MipChain::GetLevelCount(m_Width, m_Height);
+	if (m_MipLevels <= 0 || m_MipLevels > fullChain)
+		m_MipLevels = fullChain;
+
+	GLCall(glGenTextures(1, &m_RendererID));
+	GLState::BindTexture(GL_TEXTURE_2D_ARRAY, m_RendererID);
+
+	GLCall(glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, m_MipLevels > 1 ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR));
+	GLCall(glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR));
+	GLCall(glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE));
+	GLCall(glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE));
+
+	// Neither path defines the initial contents, so layers that are never set get cleared to transparent black
+	bool clearTexture = GLEW_VERSION_4_4 || GLEW_ARB_clear_texture;
+	std::vector<unsigned char> zeros;
+	if (!clearTexture)
+		zeros.resize((size_t)m_Width * m_Height * m_LayerCount * 4); // Level 0 is the largest
+
+	if (GLEW_VERSION_4_2 || GLEW_ARB_texture_storage)
+	{
+		GLCall(glTexStorage3D(GL_TEXTURE_2D_ARRAY, m_MipLevels, GL_RGBA8, m_Width, m_Height, m_LayerCount)); // The size can never change
+		for (int level = 0; level < m_MipLevels; level++)
+		{
+			if (clearTexture)
+			{
+				GLCall(glClearTexImage(m_RendererID, level, GL_RGBA, GL_UNSIGNED_BYTE, nullptr)); // nullptr clears to zero
+			}
+			else
+			{
+				GLCall(glTexSubImage3D(GL_TEXTURE_2D_ARRAY, level, 0, 0, 0, std::max(m_Width >> level, 1), std::max(m_Height >> level, 1), m_LayerCount, GL_RGBA, GL_UNSIGNED_BYTE, zeros.data()));
+			}
+		}
+	}
+	else
+	{
+		for (int level = 0; level < m_MipLevels; level++)
+		{
+			GLCall(glTexImage3D(GL_TEXTURE_2D_ARRAY, level, GL_RGBA8, std::max(m_Width >> level, 1), std::max(m_Height >> level, 1), m_LayerCount, 0, GL_RGBA, GL_UNSIGNED_BYTE, clearTexture ? nullptr : zeros.data()));
+			if (clearTexture)
+			{
+				GLCall(glClearTexImage(m_RendererID, level, GL_RGBA, GL_UNSIGNED_BYTE, nullptr));
+			}
+		}
+		GLCall(glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAX_LEVEL, m_MipLevels - 1)); // Storage does this itself, here the chain would be incomplete without it
+	}
+	GLState::BindTexture(GL_TEXTURE_2D_ARRAY, 0);
+}
+
+bool TextureArray::SetLayer(unsigned int layer, const void* rgba)
+{
+	if (layer >= m_LayerCount)
+		return false;
+
+	GLState::BindTexture(GL_TEXTURE_2D_ARRAY, m_RendererID);
+	GLCall(glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, layer, m_Width, m_Height, 1, GL_RGBA, GL_UNSIGNED_BYTE, rgba));
+	GLState::BindTexture(GL_TEXTURE_2D_ARRAY, 0);
+	return true;
+}
+
+bool TextureArray::LoadLayer(unsigned int layer, const std::string& path)
+{
+	int width = 0, height = 0, bpp = 0;
+	stbi_set_flip_vertically_on_load(1); // Same orientation as Texture
+	unsigned char* pixels;
+	{
+		PROFILE_SCOPE("Texture Decode");
+		pixels = stbi_load(path.c_str(), &width, &height, &bpp, 4);
+	}
+	if (!pixels)
+	{
+		std::cout << "Failed to load '" << path << "' for texture array layer " << layer << "!" << std::endl;
+		return false;
+	}
+
+	bool loaded = false;
+	if (width != m_Width || height != m_Height)
+	{
+		std::cout << "'" << path << "' is " << width << "x" << height << " but the texture array is " << m_Width << "x" << m_Height << ", layer " << layer << " left empty!" << std::endl;
+	}
+	else
+	{
+		PROFILE_SCOPE("Texture Upload");
+		loaded = SetLayer(layer, pixels);
+	}
+	stbi_image_free(pixels);
+	return loaded;
+}
+
+void TextureArray::GenerateMipmaps() const
+{
+	if (m_MipLevels <= 1)
+		return;
+
+	GLState::BindTexture(GL_TEXTURE_2D_ARRAY, m_RendererID);
+	GLCall(glGenerateMipmap(GL_TEXTURE_2D_ARRAY)); // Every layer, each on its own
+	GLState::BindTexture(GL_TEXTURE_2D_ARRAY, 0);
+}
+
+void TextureArray::Bind(unsigned int slot) const
+{
+	GLState::BindTexture(slot, GL_TEXTURE_2D_ARRAY, m_RendererID);
+}
+
+void TextureArray::Unbind() const
+{
+	GLState::BindTexture(GL_TEXTURE_2D_ARRAY, 0);
+}
+
+int TextureArray::GetMaxLayers()
+{
+	int layers = 0;
+	GLCall(glGetIntegerv(GL_MAX_ARRAY_TEXTURE_LAYERS, &layers));
+	return layers;
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include "GLPrerequisites.h"
+
+#include <string>
+#include <vector>
+
+/*
+GL_TEXTURE_2D_ARRAY of same-sized RGBA8 images, one per layer, sampled in GLSL through a sampler2DArray
+with vec3(uv, layer). A whole set of sprites is one bind, the layer comes with each vertex (see
+BatchRenderer::Submit with a TextureArray).
+
+Storage is immutable (glTexStorage3D, GL 4.2 or ARB_texture_storage) and sized for every layer and mip
+level up front, older contexts get the same levels through glTexImage3D. Every layer starts out
+transparent black. Layers set after construction only update level 0, call GenerateMipmaps once they
+are all in.
+*/
+class TextureArray
+{
+private:
+	unsigned int m_RendererID;
+	int m_Width, m_Height;
+	unsigned int m_LayerCount;
+	int m_MipLevels;
+public:
+	TextureArray(int width, int height, unsigned int layerCount, int mipLevels = 0); // 0 for a full mip chain, layers start transparent black
+	TextureArray(const std::vector<std::string>& paths, int mipLevels = 0); // Layer i from paths[i], all the size of the first one
+	~TextureArray();
+
+	bool SetLayer(unsigned int layer, const void* rgba); // Level 0, bottom row first
+	bool LoadLayer(unsigned int layer, const std::string& path); // False if unreadable or not the array's size
+	void GenerateMipmaps() const;
+
+	void Bind(unsigned int slot = 0) const;
+	void Unbind() const;
+
+	inline unsigned int GetRendererID() const { return m_RendererID; }
+	inline int GetWidth() const { return m_Width; }
+	inline int GetHeight() const { return m_Height; }
+	inline unsigned int GetLayerCount() const { return m_LayerCount; }
+	inline int GetMipLevels() const { return m_MipLevels; }
+
+	static int GetMaxLayers(); // GL_MAX_ARRAY_TEXTURE_LAYERS, at least 256 on GL 3.3
+private:
+	void Create();
+};
@@ -0,0 +1,612 @@
+#include "TextureAtlas.h"
+
+#include "stb_image.h"
+
+#include "CPUProfiler.h"
+#include "GLState.h"
+#include "Hash.h"
+#include "ImageWriter.h"
+
+#include <algorithm>
+#include <climits>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+static const char* s_Magic = "TextureAtlas";
+static const int s_Version = 1;
+
+struct PackRect
+{
+    int X, Y, Width, Height;
+
+    bool Contains(const PackRect& other) const
+    {
+        return other.X >= X && other.Y >= Y && other.X + other.Width <= X + Width && other.Y + other.Height <= Y + Height;
+    }
+};
+
+class Packer // One page, in grid cells rather than texels when mips need aligned images
+{
+public:
+    virtual ~Packer() {}
+    virtual bool Insert(int width, int height, int& x, int& y) = 0;
+};
+
+// Jukka Jylänki's MaxRects with the best short side fit heuristic: free space is kept as every maximal
+// free rectangle, overlapping, and each image goes where it leaves the least of one side over
+class MaxRectsPacker : public Packer
+{
+private:
+    std::vector<PackRect> m_Free;
+public:
+    MaxRectsPacker(int width, int height)
+        : m_Free{ { 0, 0, width, height } }
+    {
+    }
+
+    bool Insert(int width, int height, int& x, int& y) override
+    {
+        int bestShort = INT_MAX, bestLong = INT_MAX;
+        for (const PackRect& free : m_Free)
+        {
+            if (free.Width < width || free.Height < height)
+                continue;
+
+            int leftoverX = free.Width - width, leftoverY = free.Height - height;
+            int shortSide = std::min(leftoverX, leftoverY), longSide = std::max(leftoverX, leftoverY);
+            if (shortSide < bestShort || (shortSide == bestShort && longSide < bestLong))
+            {
+                bestShort = shortSide;
+                bestLong = longSide;
+                x = free.X;
+                y = free.Y;
+            }
+        }
+        if (bestShort == INT_MAX)
+            return false;
+
+        PackRect placed = { x, y, width, height };
+        size_t count = m_Free.size();
+        for (size_t i = 0; i < count;)
+        {
+            if (Split(m_Free[i], placed))
+            {
+                m_Free.erase(m_Free.begin() + i);
+                count--;
+            }
+            else
+            {
+                i++;
+            }
+        }
+        Prune();
+        return true;
+    }
+private:
+    bool Split(PackRect free, const PackRect& placed) // By value, the pushes below can move m_Free
+    {
+        if (placed.X >= free.X + free.Width || placed.X + placed.Width <= free.X || placed.Y >= free.Y + free.Height || placed.Y + placed.Height <= free.Y)
+            return false;
+
+        if (placed.X > free.X) // What's left of the placed rectangle, and so on for each side
+            m_Free.push_back({ free.X, free.Y, placed.X - free.X, free.Height });
+        if (placed.X + placed.Width < free.X + free.Width)
+            m_Free.push_back({ placed.X + placed.Width, free.Y, free.X + free.Width - (placed.X + placed.Width), free.Height });
+        if (placed.Y > free.Y)
+            m_Free.push_back({ free.X, free.Y, free.Width, placed.Y - free.Y });
+        if (placed.Y + placed.Height < free.Y + free.Height)
+            m_Free.push_back({ free.X, placed.Y + placed.Height, free.Width, free.Y + free.Height - (placed.Y + placed.Height) });
+        return true;
+    }
+
+    void Prune() // Drops free rectangles inside others, they'd never be the better choice
+    {
+        for (size_t i = 0; i < m_Free.size(); i++)
+        {
+            for (size_t j = i + 1; j < m_Free.size(); j++)
+            {
+                if (m_Free[j].Contains(m_Free[i]))
+                {
+                    m_Free.erase(m_Free.begin() + i);
+                    i--;
+                    break;
+                }
+                if (m_Free[i].Contains(m_Free[j]))
+                {
+                    m_Free.erase(m_Free.begin() + j);
+                    j--;
+                }
+            }
+        }
+    }
+};
+
+// Skyline bottom left: only the top edge of what's been placed is remembered, each image goes where its
+// top ends up lowest. Wastes the holes under overhangs but stays fast however many images there are
+class SkylinePacker : public Packer
+{
+private:
+    struct Node
+    {
+        int X, Y, Width;
+    };
+
+    std::vector<Node> m_Nodes;
+    int m_Width, m_Height;
+public:
+    SkylinePacker(int width, int height)
+        : m_Nodes{ { 0, 0, width } }, m_Width(width), m_Height(height)
+    {
+    }
+
+    bool Insert(int width, int height, int& x, int& y) override
+    {
+        int bestTop = INT_MAX, bestWidth = INT_MAX;
+        size_t bestIndex = 0;
+        for (size_t i = 0; i < m_Nodes.size(); i++)
+        {
+            int fitY = 0;
+            if (!Fit(i, width, height, fitY))
+                continue;
+
+            if (fitY + height < bestTop || (fitY + height == bestTop && m_Nodes[i].Width < bestWidth))
+            {
+                bestTop = fitY + height;
+                bestWidth = m_Nodes[i].Width;
+                bestIndex = i;
+                x = m_Nodes[i].X;
+                y = fitY;
+            }
+        }
+        if (bestTop == INT_MAX)
+            return false;
+
+        m_Nodes.insert(m_Nodes.begin() + bestIndex, { x, y + height, width });
+        for (size_t i = bestIndex + 1; i < m_Nodes.size();) // Cut the nodes the new one now covers
+        {
+            int coveredTo = m_Nodes[i - 1].X + m_Nodes[i - 1].Width;
+            if (m_Nodes[i].X >= coveredTo)
+                break;
+
+            int shrink = coveredTo - m_Nodes[i].X;
+            m_Nodes[i].X += shrink;
+            m_Nodes[i].Width -= shrink;
+            if (m_Nodes[i].Width > 0)
+                break;
+            m_Nodes.erase(m_Nodes.begin() + i);
+        }
+        for (size_t i = 0; i + 1 < m_Nodes.size();) // Merge neighbours at the same height
+        {
+            if (m_Nodes[i].Y == m_Nodes[i + 1].Y)
+            {
+                m_Nodes[i].Width += m_Nodes[i + 1].Width;
+                m_Nodes.erase(m_Nodes.begin() + i + 1);
+            }
+            else
+            {
+                i++;
+            }
+        }
+        return true;
+    }
+private:
+    bool Fit(size_t index, int width, int height, int& y) const // Rests on the highest node it spans
+    {
+        if (m_Nodes[index].X + width > m_Width)
+            return false;
+
+        y = 0;
+        for (size_t i = index; width > 0; i++)
+        {
+            if (i == m_Nodes.size())
+                return false;
+            y = std::max(y, m_Nodes[i].Y);
+            if (y + height > m_Height)
+                return false;
+            width -= m_Nodes[i].Width;
+        }
+        return true;
+    }
+};
+
+static std::unique_ptr<Packer> CreatePacker(AtlasPacking packing, int width, int height)
+{
+    if (packing == AtlasPacking::Skyline)
+        return std::make_unique<SkylinePacker>(width, height);
+    return std::make_unique<MaxRectsPacker>(width, height);
+}
+
+static bool ReadBytes(const std::string& path, std::vector<unsigned char>& bytes)
+{
+    std::ifstream stream(path, std::ios::binary | std::ios::ate);
+    if (!stream)
+        return false;
+
+    bytes.resize((size_t)stream.tellg());
+    stream.seekg(0);
+    return (bool)stream.read((char*)bytes.data(), bytes.size());
+}
+
+static int NextPowerOfTwo(int value)
+{
+    int power = 1;
+    while (power < value)
+        power <<= 1;
+    return power;
+}
+
+static std::string PagePath(const std::string& atlasPath, unsigned int page)
+{
+    return atlasPath + "." + std::to_string(page) + ".png";
+}
+
+TextureAtlas::TextureAtlas(const AtlasSettings& settings)
+    : m_Settings(settings), m_Hash(0)
+{
+    ASSERT(settings.MipLevels >= 1 && settings.PageSize % (1 << (settings.MipLevels - 1)) == 0);
+}
+
+void TextureAtlas::Add(const std::string& name, const std::string& path)
+{
+    Image image;
+    image.Name = name;
+    image.FilePath = path;
+    m_Images.push_back(std::move(image));
+}
+
+void TextureAtlas::Add(const std::string& name, int width, int height, const unsigned char* rgba)
+{
+    Image image;
+    image.Name = name;
+    image.Width = width;
+    image.Height = height;
+    image.Pixels.assign(rgba, rgba + (size_t)width * height * 4);
+    m_Images.push_back(std::move(image));
+}
+
+uint64_t TextureAtlas::HashInputs(std::vector<std::vector<unsigned char>>* files) const
+{
+    int settings[4] = { m_Settings.PageSize, m_Settings.Padding, m_Settings.MipLevels, (int)m_Settings.Packing };
+    uint64_t hash = Hash::FNV1a(settings, sizeof(settings));
+
+    std::vector<unsigned char> bytes;
+    for (size_t i = 0; i < m_Images.size(); i++)
+    {
+        const Image& image = m_Images[i];
+        hash = Hash::FNV1a(image.Name.c_str(), image.Name.size() + 1, hash); // Terminators keep "ab"+"c" apart from "a"+"bc"
+        hash = Hash::FNV1a(image.FilePath.c_str(), image.FilePath.size() + 1, hash);
+        if (image.FilePath.empty())
+        {
+            int size[2] = { image.Width, image.Height };
+            hash = Hash::FNV1a(size, sizeof(size), hash);
+            hash = Hash::FNV1a(image.Pixels.data(), image.Pixels.size(), hash);
+            continue;
+        }
+
+        std::vector<unsigned char>& contents = files ? (*files)[i] : bytes;
+        if (ReadBytes(image.FilePath, contents))
+            hash = Hash::FNV1a(contents.data(), contents.size(), hash);
+        else
+            contents.clear();
+    }
+    return hash;
+}
+
+bool TextureAtlas::Build()
+{
+    PROFILE_FUNCTION();
+    m_Pages.clear();
+    m_Regions.clear();
+
+    std::vector<std::vector<unsigned char>> files(m_Images.size());
+    m_Hash = HashInputs(&files);
+
+    // Decoded inputs, pointing into Pixels for images added from memory
+    struct Decoded
+    {
+        const unsigned char* Pixels = nullptr;
+        int Width = 0, Height = 0;
+        bool Owned = false;
+    };
+    std::vector<Decoded> decoded(m_Images.size());
+    auto freeDecoded = [&decoded]()
+    {
+        for (Decoded& image : decoded)
+        {
+            if (image.Owned)
+                stbi_image_free((void*)image.Pixels);
+        }
+    };
+
+    stbi_set_flip_vertically_on_load(1); // Bottom row first, like Texture
+    for (size_t i = 0; i < m_Images.size(); i++)
+    {
+        const Image& image = m_Images[i];
+        if (image.FilePath.empty())
+        {
+            decoded[i] = { image.Pixels.data(), image.Width, image.Height, false };
+            continue;
+        }
+
+        int bpp = 0;
+        unsigned char* pixels = files[i].empty() ? nullptr : stbi_load_from_memory(files[i].data(), (int)files[i].size(), &decoded[i].Width, &decoded[i].Height, &bpp, 4);
+        if (!pixels)
+        {
+            std::cout << "Failed to load '" << image.FilePath << "' for atlas image '" << image.Name << "'!" << std::endl;
+            freeDecoded();
+            return false;
+        }
+        decoded[i].Pixels = pixels;
+        decoded[i].Owned = true;
+    }
+
+    // Packed in cells of 'grid' texels so every image starts and ends on a texel of the smallest mip
+    const int grid = 1 << (m_Settings.MipLevels - 1);
+    const int padding = std::max(m_Settings.Padding, m_Settings.MipLevels > 1 ? grid : 0);
+    const int pageCells = m_Settings.PageSize / grid;
+
+    std::vector<unsigned int> order(m_Images.size());
+    for (unsigned int i = 0; i < order.size(); i++)
+        order[i] = i;
+    std::stable_sort(order.begin(), order.end(), [&decoded](unsigned int a, unsigned int b) // Biggest first packs tightest
+    {
+        int sideA = std::max(decoded[a].Width, decoded[a].Height), sideB = std::max(decoded[b].Width, decoded[b].Height);
+        if (sideA != sideB)
+            return sideA > sideB;
+        return decoded[a].Width * decoded[a].Height > decoded[b].Width * decoded[b].Height;
+    });
+
+    struct Placement
+    {
+        unsigned int Page;
+        int X, Y; // Cells
+    };
+    std::vector<Placement> placements(m_Images.size());
+    std::vector<std::unique_ptr<Packer>> packers;
+    std::vector<glm::ivec2> used; // Cells each page needs
+    for (unsigned int index : order)
+    {
+        int cellsX = (decoded[index].Width + 2 * padding + grid - 1) / grid;
+        int cellsY = (decoded[index].Height + 2 * padding + grid - 1) / grid;
+        if (cellsX > pageCells || cellsY > pageCells)
+        {
+            std::cout << "Atlas image '" << m_Images[index].Name << "' (" << decoded[index].Width << "x" << decoded[index].Height << ") doesn't fit in a " << m_Settings.PageSize << " page!" << std::endl;
+            freeDecoded();
+            return false;
+        }
+
+        Placement& placement = placements[index];
+        bool placed = false;
+        for (unsigned int page = 0; page < packers.size() && !placed; page++)
+        {
+            placed = packers[page]->Insert(cellsX, cellsY, placement.X, placement.Y);
+            placement.Page = page;
+        }
+        if (!placed) // Full everywhere, start another page
+        {
+            packers.push_back(CreatePacker(m_Settings.Packing, pageCells, pageCells));
+            used.push_back(glm::ivec2(0));
+            placement.Page = (unsigned int)packers.size() - 1;
+            packers.back()->Insert(cellsX, cellsY, placement.X, placement.Y);
+        }
+        used[placement.Page] = glm::max(used[placement.Page], glm::ivec2(placement.X + cellsX, placement.Y + cellsY));
+    }
+
+    std::vector<glm::ivec2> pageSizes(packers.size());
+    std::vector<std::vector<unsigned char>> pages(packers.size());
+    for (size_t page = 0; page < packers.size(); page++)
+    {
+        pageSizes[page].x = std::min(NextPowerOfTwo(used[page].x * grid), m_Settings.PageSize);
+        pageSizes[page].y = std::min(NextPowerOfTwo(used[page].y * grid), m_Settings.PageSize);
+        pages[page].resize((size_t)pageSizes[page].x * pageSizes[page].y * 4, 0);
+    }
+
+    m_Regions.resize(m_Images.size());
+    for (size_t i = 0; i < m_Images.size(); i++)
+    {
+        const Decoded& image = decoded[i];
+        const Placement& placement = placements[i];
+        const int pageWidth = pageSizes[placement.Page].x;
+        unsigned char* page = pages[placement.Page].data();
+        const int blockX = placement.X * grid, blockY = placement.Y * grid;
+        const int blockWidth = (image.Width + 2 * padding + grid - 1) / grid * grid;
+        const int blockHeight = (image.Height + 2 * padding + grid - 1) / grid * grid;
+
+        // The whole block is filled, the gutter and any alignment slack repeat the nearest edge texel
+        for (int row = 0; row < blockHeight; row++)
+        {
+            const unsigned char* source = image.Pixels + (size_t)std::min(std::max(row - padding, 0), image.Height - 1) * image.Width * 4;
+            unsigned char* destination = page + ((size_t)(blockY + row) * pageWidth + blockX) * 4;
+            for (int column = 0; column < padding; column++)
+                memcpy(destination + column * 4, source, 4);
+            memcpy(destination + padding * 4, source, (size_t)image.Width * 4);
+            for (int column = padding + image.Width; column < blockWidth; column++)
+                memcpy(destination + column * 4, source + (image.Width - 1) * 4, 4);
+        }
+
+        AtlasRegion& region = m_Regions[i];
+        region.PageIndex = placement.Page;
+        region.X = blockX + padding;
+        region.Y = blockY + padding;
+        region.Width = image.Width;
+        region.Height = image.Height;
+    }
+    freeDecoded();
+
+    for (size_t page = 0; page < pages.size(); page++)
+        CreatePage(pageSizes[page].x, pageSizes[page].y, pages[page].data());
+    FinishRegions();
+    return true;
+}
+
+bool TextureAtlas::Build(const std::string& atlasPath)
+{
+    if (Load(atlasPath))
+        return true;
+    if (!Build())
+        return false;
+    Save(atlasPath); // Still usable if this fails, the next launch just packs again
+    return true;
+}
+
+bool TextureAtlas::Save(const std::string& atlasPath) const
+{
+    std::ostringstream metadata;
+    metadata << s_Magic << " " << s_Version << "\n";
+    metadata << "hash " << std::hex << m_Hash << std::dec << "\n";
+
+    std::vector<unsigned char> pixels;
+    for (unsigned int i = 0; i < m_Pages.size(); i++)
+    {
+        const Texture& page = *m_Pages[i];
+        metadata << "page " << page.GetWidth() << " " << page.GetHeight() << "\n";
+
+        pixels.resize((size_t)page.GetWidth() * page.GetHeight() * 4);
+        GLState::BindTexture(GL_TEXTURE_2D, page.GetRendererID());
+        GLCall(glGetTexImage(GL_TEXTURE_2D, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data())); // Bottom row first, as ImageWriter wants
+        GLState::BindTexture(GL_TEXTURE_2D, 0);
+        if (!ImageWriter::WritePNG(PagePath(atlasPath, i), page.GetWidth(), page.GetHeight(), pixels.data()))
+            return false;
+    }
+    for (size_t i = 0; i < m_Regions.size(); i++)
+    {
+        const AtlasRegion& region = m_Regions[i];
+        metadata << "region " << region.PageIndex << " " << region.X << " " << region.Y << " " << region.Width << " " << region.Height << " " << m_Images[i].Name << "\n"; // Name last, it may have spaces
+    }
+
+    std::ofstream stream(atlasPath, std::ios::trunc);
+    stream << metadata.str();
+    if (!stream)
+    {
+        std::cout << "Failed to write texture atlas '" << atlasPath << "'" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool TextureAtlas::Load(const std::string& atlasPath)
+{
+    PROFILE_FUNCTION();
+    std::ifstream stream(atlasPath);
+    if (!stream) // Never saved, not worth a message
+        return false;
+
+    std::string magic, key;
+    int version = 0;
+    uint64_t hash = 0;
+    if (!(stream >> magic >> version) || magic != s_Magic || version != s_Version
+        || !(stream >> key >> std::hex >> hash >> std::dec) || key != "hash")
+    {
+        std::cout << "'" << atlasPath << "' is not a texture atlas, packing again" << std::endl;
+        return false;
+    }
+    uint64_t inputHash = HashInputs(nullptr);
+    if (hash != inputHash)
+    {
+        std::cout << "'" << atlasPath << "' was packed from different images, packing again" << std::endl;
+        return false;
+    }
+
+    std::vector<glm::ivec2> pageSizes;
+    std::vector<AtlasRegion> regions;
+    std::vector<std::string> names;
+    while (stream >> key)
+    {
+        if (key == "page")
+        {
+            glm::ivec2 size;
+            stream >> size.x >> size.y;
+            pageSizes.push_back(size);
+        }
+        else if (key == "region")
+        {
+            AtlasRegion region;
+            std::string name;
+            stream >> region.PageIndex >> region.X >> region.Y >> region.Width >> region.Height;
+            stream.ignore(1); // The space before the name
+            std::getline(stream, name);
+            if (region.PageIndex >= pageSizes.size())
+                break;
+            regions.push_back(region);
+            names.push_back(name);
+        }
+        else
+        {
+            break;
+        }
+    }
+    if (!stream.eof() || regions.size() != m_Images.size())
+    {
+        std::cout << "'" << atlasPath << "' is damaged, packing again" << std::endl;
+        return false;
+    }
+    for (size_t i = 0; i < names.size(); i++)
+    {
+        if (names[i] != m_Images[i].Name)
+        {
+            std::cout << "'" << atlasPath << "' is damaged, packing again" << std::endl;
+            return false;
+        }
+    }
+
+    m_Pages.clear();
+    for (unsigned int i = 0; i < pageSizes.size(); i++)
+    {
+        CreatePage(PagePath(atlasPath, i));
+        if (m_Pages.back()->GetWidth() != pageSizes[i].x || m_Pages.back()->GetHeight() != pageSizes[i].y)
+        {
+            std::cout << "Texture atlas page '" << PagePath(atlasPath, i) << "' is missing or the wrong size, packing again" << std::endl;
+            m_Pages.clear();
+            return false;
+        }
+    }
+
+    m_Regions = regions;
+    m_Hash = hash;
+    FinishRegions();
+    return true;
+}
+
+const AtlasRegion& TextureAtlas::Get(const std::string& name) const
+{
+    static const AtlasRegion s_Invalid;
+    auto it = m_RegionIndices.find(name);
+    if (it == m_RegionIndices.end())
+        return s_Invalid;
+    return m_Regions[it->second];
+}
+
+void TextureAtlas::CreatePage(int width, int height, const unsigned char* rgba)
+{
+    m_Pages.push_back(std::make_unique<Texture>(width, height, rgba));
+    SetPageMipmaps(*m_Pages.back());
+}
+
+void TextureAtlas::CreatePage(const std::string& path)
+{
+    m_Pages.push_back(std::make_unique<Texture>(path));
+    SetPageMipmaps(*m_Pages.back());
+}
+
+void TextureAtlas::SetPageMipmaps(const Texture& page) const
+{
+    if (m_Settings.MipLevels > 1)
+        page.GenerateMipmaps(m_Settings.MipLevels); // Levels past this would blend neighbouring images
+}
+
+void TextureAtlas::FinishRegions()
+{
+    m_RegionIndices.clear();
+    for (unsigned int i = 0; i < m_Regions.size(); i++)
+    {
+        AtlasRegion& region = m_Regions[i];
+        const Texture& page = *m_Pages[region.PageIndex];
+        glm::vec2 pageSize((float)page.GetWidth(), (float)page.GetHeight());
+        region.Page = &page;
+        region.UVMin = glm::vec2((float)region.X, (float)region.Y) / pageSize;
+        region.UVMax = glm::vec2((float)(region.X + region.Width), (float)(region.Y + region.Height)) / pageSize;
+        m_RegionIndices[m_Images[i].Name] = i;
+    }
+}
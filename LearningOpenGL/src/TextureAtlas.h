@@ -0,0 +1,95 @@
+#pragma once
+
+#include "GLPrerequisites.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "Texture.h"
+
+#include "glm.hpp"
+
+enum class AtlasPacking
+{
+	MaxRects, // Best short side fit, packs tighter
+	Skyline // Bottom left, faster with thousands of images
+};
+
+struct AtlasSettings
+{
+	int PageSize = 2048; // Most a page can grow to, each page is shrunk to the power of two its images need
+	int Padding = 2; // Gutter around every image, filled by repeating its edge texels so filtering never reaches a neighbour
+	int MipLevels = 1; // Above 1, images are aligned to 2^(MipLevels - 1) texels and the gutter grows to match, so every level stays clean
+	AtlasPacking Packing = AtlasPacking::MaxRects;
+};
+
+struct AtlasRegion // Where one image ended up, valid as long as its TextureAtlas
+{
+	const Texture* Page = nullptr; // Bind this, nullptr if the atlas has no such image
+	unsigned int PageIndex = 0;
+	int X = 0, Y = 0, Width = 0, Height = 0; // Texels without the gutter, Y up from the bottom row like GL
+	glm::vec2 UVMin = glm::vec2(0.0f);
+	glm::vec2 UVMax = glm::vec2(1.0f);
+
+	inline bool IsValid() const { return Page != nullptr; }
+};
+
+/*
+Packs many small images into a few large textures at load time, so sprites drawn from the same page share
+one bind (see BatchRenderer::Submit with an AtlasRegion). Images are added by name, Build decodes and
+packs them all at once:
+
+    TextureAtlas sprites;
+    sprites.Add("gojo", "res/textures/GojoTexture256x256.png");
+    sprites.Build("res/atlas/sprites.atlas"); // Loads the saved atlas if it was made from the same images
+    const AtlasRegion& gojo = sprites.Get("gojo");
+
+A saved atlas is a text file of page sizes and regions next to one PNG per page ("<path>.<page>.png").
+It remembers a hash of the settings and of every input's name and bytes, so changing any image makes
+it stale and the next Build packs again and overwrites it.
+*/
+class TextureAtlas
+{
+private:
+	struct Image
+	{
+		std::string Name;
+		std::string FilePath; // Empty for images added from memory
+		int Width = 0, Height = 0;
+		std::vector<unsigned char> Pixels; // RGBA8 bottom row first, only for images added from memory
+	};
+
+	AtlasSettings m_Settings;
+	std::vector<Image> m_Images;
+	std::vector<std::unique_ptr<Texture>> m_Pages;
+	std::vector<AtlasRegion> m_Regions; // Same order as m_Images
+	std::unordered_map<std::string, unsigned int> m_RegionIndices;
+	uint64_t m_Hash; // Of the settings and inputs the current pages were made from
+public:
+	TextureAtlas(const AtlasSettings& settings = AtlasSettings());
+
+	void Add(const std::string& name, const std::string& path); // Not read until Build
+	void Add(const std::string& name, int width, int height, const unsigned char* rgba); // Copied, rows bottom-up as Texture expects
+
+	bool Build(); // Decodes, packs and uploads everything added, false if an image couldn't be read or is bigger than a page
+	bool Build(const std::string& atlasPath); // Load, or Build and Save when the saved atlas is missing or stale
+
+	bool Save(const std::string& atlasPath) const; // The directory must exist
+	bool Load(const std::string& atlasPath); // False if missing, unreadable, or made from different images or settings
+
+	const AtlasRegion& Get(const std::string& name) const; // An invalid region if there is no such image
+
+	inline unsigned int GetPageCount() const { return (unsigned int)m_Pages.size(); }
+	inline const Texture& GetPage(unsigned int index) const { return *m_Pages[index]; }
+	inline const std::vector<AtlasRegion>& GetRegions() const { return m_Regions; }
+	inline const AtlasSettings& GetSettings() const { return m_Settings; }
+private:
+	uint64_t HashInputs(std::vector<std::vector<unsigned char>>* files) const; // Also hands back the file contents when asked, so Build reads each once
+	void CreatePage(int width, int height, const unsigned char* rgba);
+	void CreatePage(const std::string& path);
+	void SetPageMipmaps(const Texture& page) const;
+	void FinishRegions();
+};
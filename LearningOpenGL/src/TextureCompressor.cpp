@@ -0,0 +1,336 @@
+#include "TextureCompressor.h"
+
+#include "stb_image.h"
+
+#include "CPUProfiler.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <thread>
+
+static const int s_BC7Weights[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+struct BitWriter // LSB first, into zeroed output
+{
+	unsigned char* Output;
+	unsigned int Position;
+
+	void Put(unsigned int value, unsigned int bits)
+	{
+		for (unsigned int i = 0; i < bits; i++, Position++)
+		{
+			if ((value >> i) & 1)
+				Output[Position >> 3] |= (unsigned char)(1 << (Position & 7));
+		}
+	}
+};
+
+static void FitLine(const unsigned char texels[16 * 4], int channels, float low[4], float high[4]) // Ends of the principal axis through the block
+{
+	float mean[4] = {};
+	for (int i = 0; i < 16; i++)
+	{
+		for (int c = 0; c < channels; c++)
+			mean[c] += texels[i * 4 + c] / 16.0f;
+	}
+
+	float covariance[4][4] = {};
+	float axis[4] = {};
+	for (int i = 0; i < 16; i++)
+	{
+		for (int a = 0; a < channels; a++)
+		{
+			for (int b = 0; b < channels; b++)
+				covariance[a][b] += (texels[i * 4 + a] - mean[a]) * (texels[i * 4 + b] - mean[b]);
+			axis[a] = std::max(axis[a], std::fabs(texels[i * 4 + a] - mean[a])); // Start from the bounding box, power iteration does the rest
+		}
+	}
+	for (int iteration = 0; iteration < 8; iteration++)
+	{
+		float next[4] = {}, length = 0.0f;
+		for (int a = 0; a < channels; a++)
+		{
+			for (int b = 0; b < channels; b++)
+				next[a] += covariance[a][b] * axis[b];
+			length += next[a] * next[a];
+		}
+		if (length < 1e-12f)
+			break;
+		for (int a = 0; a < channels; a++)
+			axis[a] = next[a] / std::sqrt(length);
+	}
+
+	float minimum = 0.0f, maximum = 0.0f;
+	for (int i = 0; i < 16; i++)
+	{
+		float t = 0.0f;
+		for (int c = 0; c < channels; c++)
+			t += (texels[i * 4 + c] - mean[c]) * axis[c];
+		minimum = std::min(minimum, t);
+		maximum = std::max(maximum, t);
+	}
+	for (int c = 0; c < 4; c++)
+	{
+		low[c] = c < channels ? std::min(std::max(mean[c] + axis[c] * minimum, 0.0f), 255.0f) : 255.0f;
+		high[c] = c < channels ? std::min(std::max(mean[c] + axis[c] * maximum, 0.0f), 255.0f) : 255.0f;
+	}
+}
+
+static unsigned int Nearest(const unsigned char* texel, const int palette[][4], int count, int channels)
+{
+	unsigned int best = 0;
+	int bestError = 0x7fffffff;
+	for (int i = 0; i < count; i++)
+	{
+		int error = 0;
+		for (int c = 0; c < channels; c++)
+			error += (texel[c] - palette[i][c]) * (texel[c] - palette[i][c]);
+		if (error < bestError)
+		{
+			best = i;
+			bestError = error;
+		}
+	}
+	return best;
+}
+
+static unsigned short To565(const float color[4])
+{
+	int r = (int)(color[0] * 31.0f / 255.0f + 0.5f), g = (int)(color[1] * 63.0f / 255.0f + 0.5f), b = (int)(color[2] * 31.0f / 255.0f + 0.5f);
+	return (unsigned short)((r << 11) | (g << 5) | b);
+}
+
+static void From565(unsigned short color, int result[4])
+{
+	int r = (color >> 11) & 31, g = (color >> 5) & 63, b = color & 31;
+	result[0] = (r << 3) | (r >> 2);
+	result[1] = (g << 2) | (g >> 4);
+	result[2] = (b << 3) | (b >> 2);
+	result[3] = 255;
+}
+
+static void EncodeColor(const unsigned char texels[16 * 4], unsigned char* output) // BC1 block, always the opaque four colour mode
+{
+	float low[4], high[4];
+	FitLine(texels, 3, low, high);
+	unsigned short color0 = To565(high), color1 = To565(low);
+	if (color0 < color1)
+		std::swap(color0, color1);
+
+	unsigned int indices = 0;
+	if (color0 != color1) // Equal endpoints would pick the three colour mode, index 0 is right for every texel then anyway
+	{
+		int palette[4][4];
+		From565(color0, palette[0]);
+		From565(color1, palette[1]);
+		for (int c = 0; c < 3; c++)
+		{
+			palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+			palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+		}
+		for (int i = 0; i < 16; i++)
+			indices |= Nearest(&texels[i * 4], palette, 4, 3) << (i * 2);
+	}
+
+	std::memcpy(output, &color0, 2);
+	std::memcpy(output + 2, &color1, 2);
+	std::memcpy(output + 4, &indices, 4);
+}
+
+static void EncodeChannel(const unsigned char texels[16 * 4], int channel, unsigned char* output) // BC4 block of one channel, the eight value mode
+{
+	int minimum = 255, maximum = 0;
+	for (int i = 0; i < 16; i++)
+	{
+		minimum = std::min(minimum, (int)texels[i * 4 + channel]);
+		maximum = std::max(maximum, (int)texels[i * 4 + channel]);
+	}
+
+	int palette[8][4] = { { maximum }, { minimum } };
+	for (int i = 2; i < 8; i++)
+		palette[i][0] = ((8 - i) * maximum + (i - 1) * minimum) / 7;
+
+	uint64_t indices = 0;
+	for (int i = 0; i < 16 && maximum != minimum; i++)
+		indices |= (uint64_t)Nearest(&texels[i * 4 + channel], palette, 8, 1) << (i * 3);
+
+	output[0] = (unsigned char)maximum;
+	output[1] = (unsigned char)minimum;
+	for (int i = 0; i < 6; i++)
+		output[2 + i] = (unsigned char)(indices >> (i * 8));
+}
+
+static void QuantizeBC7(const float endpoint[4], int quantized[4], int& pBit) // 7 bits a channel and a shared low bit, whichever p bit is closer
+{
+	float bestError = 1e30f;
+	for (int p = 0; p < 2; p++)
+	{
+		int candidate[4];
+		float error = 0.0f;
+		for (int c = 0; c < 4; c++)
+		{
+			candidate[c] = std::min(std::max((int)((endpoint[c] - p) / 2.0f + 0.5f), 0), 127);
+			float difference = (float)((candidate[c] << 1) | p) - endpoint[c];
+			error += difference * difference;
+		}
+		if (error < bestError)
+		{
+			bestError = error;
+			pBit = p;
+			std::copy(candidate, candidate + 4, quantized);
+		}
+	}
+}
+
+static void EncodeBC7(const unsigned char texels[16 * 4], unsigned char* output) // Mode 6
+{
+	float low[4], high[4];
+	FitLine(texels, 4, low, high);
+	int endpoints[2][4], pBits[2];
+	QuantizeBC7(low, endpoints[0], pBits[0]);
+	QuantizeBC7(high, endpoints[1], pBits[1]);
+
+	int palette[16][4];
+	for (int i = 0; i < 16; i++)
+	{
+		for (int c = 0; c < 4; c++)
+		{
+			int e0 = (endpoints[0][c] << 1) | pBits[0], e1 = (endpoints[1][c] << 1) | pBits[1];
+			palette[i][c] = ((64 - s_BC7Weights[i]) * e0 + s_BC7Weights[i] * e1 + 32) >> 6;
+		}
+	}
+	unsigned int indices[16];
+	for (int i = 0; i < 16; i++)
+		indices[i] = Nearest(&texels[i * 4], palette, 16, 4);
+
+	if (indices[0] >= 8) // The first index is stored with its top bit implied 0, so swap the ends to make it so
+	{
+		std::swap(endpoints[0], endpoints[1]);
+		std::swap(pBits[0], pBits[1]);
+		for (unsigned int& index : indices)
+			index = 15 - index;
+	}
+
+	std::memset(output, 0, 16);
+	BitWriter writer = { output, 0 };
+	writer.Put(1 << 6, 7);
+	for (int c = 0; c < 4; c++)
+	{
+		writer.Put(endpoints[0][c], 7);
+		writer.Put(endpoints[1][c], 7);
+	}
+	writer.Put(pBits[0], 1);
+	writer.Put(pBits[1], 1);
+	for (int i = 0; i < 16; i++)
+		writer.Put(indices[i], i == 0 ? 3 : 4);
+}
+
+void TextureCompressor::EncodeBlock(CompressedFormat format, const unsigned char texels[16 * 4], unsigned char* output)
+{
+	switch (format)
+	{
+	case CompressedFormat::BC1:
+		EncodeColor(texels, output);
+		break;
+	case CompressedFormat::BC3:
+		EncodeChannel(texels, 3, output);
+		EncodeColor(texels, output + 8);
+		break;
+	case CompressedFormat::BC4:
+		EncodeChannel(texels, 0, output);
+		break;
+	case CompressedFormat::BC5:
+		EncodeChannel(texels, 0, output);
+		EncodeChannel(texels, 1, output + 8);
+		break;
+	case CompressedFormat::BC7:
+		EncodeBC7(texels, output);
+		break;
+	default:
+		ASSERT(false); // Not encodable, see IsEncodable
+	}
+}
+
+bool TextureCompressor::IsEncodable(CompressedFormat format)
+{
+	return format == CompressedFormat::BC1 || format == CompressedFormat::BC3 || format == CompressedFormat::BC4 || format == CompressedFormat::BC5 || format == CompressedFormat::BC7;
+}
+
+CompressedImage TextureCompressor::Compress(CompressedFormat format, int width, int height, const unsigned char* rgba, unsigned int threadCount, MipFilter mipFilter)
+{
+	PROFILE_FUNCTION();
+	ASSERT(IsEncodable(format));
+	CompressedImage image;
+	image.Format = format;
+	image.Width = width;
+	image.Height = height;
+
+	std::vector<std::vector<unsigned char>> levels = MipChain::Build(width, height, rgba, mipFilter);
+	struct Row { unsigned int Level; int Y; }; // One row of blocks is one job
+	std::vector<Row> rows;
+	for (unsigned int level = 0; level < levels.size(); level++)
+	{
+		int levelWidth = std::max(width >> level, 1), levelHeight = std::max(height >> level, 1);
+		image.Levels.emplace_back(TextureContainer::GetLevelSize(format, levelWidth, levelHeight));
+		for (int y = 0; y < levelHeight; y += 4)
+			rows.push_back({ level, y });
+	}
+
+	std::atomic<size_t> next(0);
+	unsigned int blockBytes = TextureContainer::GetBlockBytes(format);
+	auto work = [&]()
+	{
+		unsigned char texels[16 * 4];
+		for (size_t job = next++; job < rows.size(); job = next++)
+		{
+			unsigned int level = rows[job].Level;
+			int levelWidth = std::max(width >> level, 1), levelHeight = std::max(height >> level, 1);
+			const unsigned char* source = levels[level].data();
+			unsigned char* destination = &image.Levels[level][(size_t)(rows[job].Y / 4) * ((levelWidth + 3) / 4) * blockBytes];
+			for (int x = 0; x < levelWidth; x += 4, destination += blockBytes)
+			{
+				for (int i = 0; i < 16; i++) // Edge blocks repeat the last texel, the GPU never samples past the edge
+				{
+					int texelX = std::min(x + (i & 3), levelWidth - 1), texelY = std::min(rows[job].Y + (i >> 2), levelHeight - 1);
+					std::memcpy(&texels[i * 4], &source[((size_t)texelY * levelWidth + texelX) * 4], 4);
+				}
+				EncodeBlock(format, texels, destination);
+			}
+		}
+	};
+
+	if (threadCount == 0)
+		threadCount = std::max(std::thread::hardware_concurrency(), 1u);
+	std::vector<std::thread> threads;
+	for (unsigned int i = 1; i < std::min<size_t>(threadCount, rows.size()); i++)
+		threads.emplace_back(work);
+	work(); // This thread helps too
+	for (std::thread& thread : threads)
+		thread.join();
+	return image;
+}
+
+bool TextureCompressor::CompressFile(const std::string& path, const std::string& outputPath, CompressedFormat format, unsigned int threadCount, MipFilter mipFilter)
+{
+	if (!IsEncodable(format))
+	{
+		std::cout << "Can't encode " << TextureContainer::GetName(format) << ", only BC1, BC3, BC4, BC5 and BC7!" << std::endl;
+		return false;
+	}
+
+	int width = 0, height = 0, bpp = 0;
+	stbi_set_flip_vertically_on_load(1); // Bottom row first, as Texture uploads PNGs
+	unsigned char* pixels = stbi_load(path.c_str(), &width, &height, &bpp, 4);
+	if (!pixels)
+	{
+		std::cout << "Failed to load '" << path << "' to compress!" << std::endl;
+		return false;
+	}
+
+	CompressedImage image = Compress(format, width, height, pixels, threadCount, mipFilter);
+	stbi_image_free(pixels);
+	return TextureContainer::SaveDDS(outputPath, image);
+}
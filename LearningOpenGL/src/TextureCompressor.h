@@ -0,0 +1,31 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "MipChain.h"
+#include "TextureContainer.h"
+
+/*
+Offline block compression of RGBA8 images, run at build time by the CompressTextures target (the app's
+"--compress-textures" switch) to turn the .png files in res/textures into DDS files with full mip chains:
+
+    LearningOpenGL --compress-textures BC7 res/textures/compressed res/textures/GojoTexture256x256.png
+
+Endpoints are fitted along each block's principal axis and every texel takes the nearest palette entry,
+so it is fast and decent, not the best an exhaustive encoder could do. BC7 uses mode 6 only (one
+RGBA subset, 7 bit endpoints and 4 bit indices). The blocks of all levels are shared out between worker
+threads. There is no ETC2 encoder, ETC2 files are only loaded.
+*/
+class TextureCompressor
+{
+private:
+	TextureCompressor() {} // Static only
+public:
+	// Rows bottom-up as Texture expects, mips are made with MipChain. threadCount 0 uses every core
+	static CompressedImage Compress(CompressedFormat format, int width, int height, const unsigned char* rgba, unsigned int threadCount = 0, MipFilter mipFilter = MipFilter::Kaiser);
+	static bool CompressFile(const std::string& path, const std::string& outputPath, CompressedFormat format, unsigned int threadCount = 0, MipFilter mipFilter = MipFilter::Kaiser); // PNG (anything stb_image reads) to DDS
+
+	static void EncodeBlock(CompressedFormat format, const unsigned char texels[16 * 4], unsigned char* output); // One 4x4 block, texels row by row
+	static bool IsEncodable(CompressedFormat format); // BC1, BC3, BC4, BC5 and BC7
+};
@@ -0,0 +1,318 @@
+#include "TextureContainer.h"
+
+#include "CPUProfiler.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+struct FormatInfo
+{
+	const char* Name;
+	unsigned int InternalFormat;
+	unsigned int BlockBytes;
+	unsigned int DxgiFormat; // 0 where DDS has none
+	unsigned int VkFormat;
+};
+
+static const FormatInfo s_Formats[(unsigned int)CompressedFormat::Count] =
+{
+	{ "BC1", GL_COMPRESSED_RGBA_S3TC_DXT1_EXT, 8, 71, 133 },
+	{ "BC3", GL_COMPRESSED_RGBA_S3TC_DXT5_EXT, 16, 77, 137 },
+	{ "BC4", GL_COMPRESSED_RED_RGTC1, 8, 80, 139 },
+	{ "BC5", GL_COMPRESSED_RG_RGTC2, 16, 83, 141 },
+	{ "BC7", GL_COMPRESSED_RGBA_BPTC_UNORM, 16, 98, 145 },
+	{ "ETC2_RGB8", GL_COMPRESSED_RGB8_ETC2, 8, 0, 147 },
+	{ "ETC2_RGBA8", GL_COMPRESSED_RGBA8_ETC2_EAC, 16, 0, 151 },
+	{ "EAC_R11", GL_COMPRESSED_R11_EAC, 8, 0, 153 },
+	{ "EAC_RG11", GL_COMPRESSED_RG11_EAC, 16, 0, 155 }
+};
+
+static const unsigned int s_DDSMagic = 0x20534444; // "DDS "
+static const unsigned int s_DDSHeaderSize = 124;
+static const unsigned int s_DDSFlagsMipMapCount = 0x20000;
+static const unsigned int s_DDPFFourCC = 0x4;
+static const unsigned char s_KTX2Identifier[12] = { 0xAB, 0x4B, 0x54, 0x58, 0x20, 0x32, 0x30, 0xBB, 0x0D, 0x0A, 0x1A, 0x0A };
+
+static unsigned int FourCC(const char* code)
+{
+	return (unsigned int)code[0] | ((unsigned int)code[1] << 8) | ((unsigned int)code[2] << 16) | ((unsigned int)code[3] << 24);
+}
+
+template<typename T>
+static T Read(const std::vector<unsigned char>& data, size_t offset) // Little endian, like every platform we build for
+{
+	T value = 0;
+	if (offset + sizeof(T) <= data.size())
+		std::memcpy(&value, &data[offset], sizeof(T));
+	return value;
+}
+
+template<typename T>
+static void Write(std::vector<unsigned char>& data, T value)
+{
+	const unsigned char* bytes = (const unsigned char*)&value;
+	data.insert(data.end(), bytes, bytes + sizeof(T));
+}
+
+static bool ReadFile(const std::string& path, std::vector<unsigned char>& data)
+{
+	std::ifstream stream(path, std::ios::binary | std::ios::ate);
+	if (!stream)
+		return false;
+
+	data.resize((size_t)stream.tellg());
+	stream.seekg(0);
+	stream.read((char*)data.data(), data.size());
+	return (bool)stream;
+}
+
+static std::string GetExtension(const std::string& path) // Lower case, without the dot
+{
+	size_t dot = path.find_last_of('.');
+	std::string extension = dot == std::string::npos ? "" : path.substr(dot + 1);
+	std::transform(extension.begin(), extension.end(), extension.begin(), [](char c) { return (char)std::tolower((unsigned char)c); });
+	return extension;
+}
+
+static bool ReadLevels(const std::vector<unsigned char>& data, size_t offset, unsigned int levelCount, CompressedImage& image) // Packed one after another from 'offset', as DDS has them
+{
+	for (unsigned int level = 0; level < levelCount; level++)
+	{
+		size_t size = TextureContainer::GetLevelSize(image.Format, std::max(image.Width >> level, 1), std::max(image.Height >> level, 1));
+		if (offset + size > data.size())
+			return false;
+
+		image.Levels.emplace_back(data.begin() + offset, data.begin() + offset + size);
+		offset += size;
+	}
+	return true;
+}
+
+bool TextureContainer::Load(const std::string& path, CompressedImage& image)
+{
+	if (GetExtension(path) == "ktx2")
+		return LoadKTX2(path, image);
+	return LoadDDS(path, image);
+}
+
+bool TextureContainer::LoadDDS(const std::string& path, CompressedImage& image)
+{
+	PROFILE_FUNCTION();
+	image = CompressedImage();
+	std::vector<unsigned char> data;
+	if (!ReadFile(path, data) || Read<uint32_t>(data, 0) != s_DDSMagic || Read<uint32_t>(data, 4) != s_DDSHeaderSize)
+	{
+		std::cout << "'" << path << "' is not a DDS file!" << std::endl;
+		return false;
+	}
+
+	unsigned int flags = Read<uint32_t>(data, 8);
+	image.Height = (int)Read<uint32_t>(data, 12);
+	image.Width = (int)Read<uint32_t>(data, 16);
+	unsigned int levelCount = (flags & s_DDSFlagsMipMapCount) ? std::max(Read<uint32_t>(data, 28), 1u) : 1;
+	unsigned int pixelFlags = Read<uint32_t>(data, 80);
+	unsigned int fourCC = Read<uint32_t>(data, 84);
+	size_t offset = 4 + s_DDSHeaderSize;
+
+	bool known = false;
+	if (pixelFlags & s_DDPFFourCC)
+	{
+		if (fourCC == FourCC("DX10"))
+		{
+			unsigned int dxgiFormat = Read<uint32_t>(data, offset);
+			unsigned int dimension = Read<uint32_t>(data, offset + 4);
+			unsigned int arraySize = Read<uint32_t>(data, offset + 12);
+			offset += 20;
+			for (unsigned int i = 0; i < (unsigned int)CompressedFormat::Count && dimension == 3 && arraySize <= 1; i++) // 3 is TEXTURE2D
+			{
+				if (s_Formats[i].DxgiFormat == dxgiFormat)
+				{
+					image.Format = (CompressedFormat)i;
+					known = true;
+				}
+			}
+		}
+		else
+		{
+			known = true;
+			if (fourCC == FourCC("DXT1"))
+				image.Format = CompressedFormat::BC1;
+			else if (fourCC == FourCC("DXT5"))
+				image.Format = CompressedFormat::BC3;
+			else if (fourCC == FourCC("ATI1") || fourCC == FourCC("BC4U"))
+				image.Format = CompressedFormat::BC4;
+			else if (fourCC == FourCC("ATI2") || fourCC == FourCC("BC5U"))
+				image.Format = CompressedFormat::BC5;
+			else
+				known = false;
+		}
+	}
+	if (!known)
+	{
+		std::cout << "DDS file '" << path << "' is not a 2D BC1, BC3, BC4, BC5 or BC7 texture!" << std::endl;
+		return false;
+	}
+
+	if (image.Width <= 0 || image.Height <= 0 || !ReadLevels(data, offset, levelCount, image))
+	{
+		std::cout << "DDS file '" << path << "' is truncated!" << std::endl;
+		return false;
+	}
+	return true;
+}
+
+bool TextureContainer::LoadKTX2(const std::string& path, CompressedImage& image)
+{
+	PROFILE_FUNCTION();
+	image = CompressedImage();
+	std::vector<unsigned char> data;
+	if (!ReadFile(path, data) || data.size() < 80 || std::memcmp(data.data(), s_KTX2Identifier, sizeof(s_KTX2Identifier)) != 0)
+	{
+		std::cout << "'" << path << "' is not a KTX2 file!" << std::endl;
+		return false;
+	}
+
+	unsigned int vkFormat = Read<uint32_t>(data, 12);
+	image.Width = (int)Read<uint32_t>(data, 20);
+	image.Height = (int)Read<uint32_t>(data, 24);
+	unsigned int depth = Read<uint32_t>(data, 28);
+	unsigned int layers = Read<uint32_t>(data, 32);
+	unsigned int faces = Read<uint32_t>(data, 36);
+	unsigned int levelCount = std::max(Read<uint32_t>(data, 40), 1u); // 0 asks the loader to make the mips, there is still only one level stored
+	unsigned int supercompression = Read<uint32_t>(data, 44);
+
+	bool known = false;
+	for (unsigned int i = 0; i < (unsigned int)CompressedFormat::Count; i++)
+	{
+		if (s_Formats[i].VkFormat == vkFormat || (i == (unsigned int)CompressedFormat::BC1 && vkFormat == 131)) // BC1_RGB too, it decodes the same without alpha
+		{
+			image.Format = (CompressedFormat)i;
+			known = true;
+		}
+	}
+	if (!known || depth > 1 || layers > 1 || faces != 1 || supercompression != 0 || image.Height <= 0)
+	{
+		std::cout << "KTX2 file '" << path << "' is not an uncompressed 2D BC or ETC2 texture (vkFormat " << vkFormat << ")!" << std::endl;
+		return false;
+	}
+
+	const size_t levelIndex = 80; // After the identifier, the header and the DFD/KVD/SGD offsets
+	for (unsigned int level = 0; level < levelCount; level++)
+	{
+		uint64_t offset = Read<uint64_t>(data, levelIndex + level * 24);
+		uint64_t length = Read<uint64_t>(data, levelIndex + level * 24 + 8);
+		size_t size = GetLevelSize(image.Format, std::max(image.Width >> level, 1), std::max(image.Height >> level, 1));
+		if (length != size || offset + length > data.size())
+		{
+			std::cout << "KTX2 file '" << path << "' is truncated!" << std::endl;
+			return false;
+		}
+		image.Levels.emplace_back(data.begin() + (size_t)offset, data.begin() + (size_t)(offset + length));
+	}
+	return true;
+}
+
+bool TextureContainer::SaveDDS(const std::string& path, const CompressedImage& image)
+{
+	const FormatInfo& info = s_Formats[(unsigned int)image.Format];
+	if (info.DxgiFormat == 0)
+	{
+		std::cout << "DDS can't hold " << info.Name << ", '" << path << "' not written!" << std::endl;
+		return false;
+	}
+
+	std::vector<unsigned char> data;
+	Write<uint32_t>(data, s_DDSMagic);
+	Write<uint32_t>(data, s_DDSHeaderSize);
+	Write<uint32_t>(data, 0x1 | 0x2 | 0x4 | 0x1000 | s_DDSFlagsMipMapCount | 0x80000); // Caps, height, width, pixel format, mip count, linear size
+	Write<uint32_t>(data, (uint32_t)image.Height);
+	Write<uint32_t>(data, (uint32_t)image.Width);
+	Write<uint32_t>(data, (uint32_t)(image.Levels.empty() ? 0 : image.Levels[0].size()));
+	Write<uint32_t>(data, 0); // Depth
+	Write<uint32_t>(data, (uint32_t)image.Levels.size());
+	data.resize(data.size() + 11 * 4, 0); // Reserved
+
+	Write<uint32_t>(data, 32); // Pixel format
+	Write<uint32_t>(data, s_DDPFFourCC);
+	Write<uint32_t>(data, FourCC("DX10"));
+	data.resize(data.size() + 5 * 4, 0); // Bit count and masks
+	Write<uint32_t>(data, 0x1000 | 0x400000 | 0x8); // Texture, mipmap, complex
+	data.resize(data.size() + 4 * 4, 0); // Caps 2 to 4 and reserved
+
+	Write<uint32_t>(data, info.DxgiFormat);
+	Write<uint32_t>(data, 3); // TEXTURE2D
+	Write<uint32_t>(data, 0);
+	Write<uint32_t>(data, 1); // Array size
+	Write<uint32_t>(data, 0);
+
+	std::ofstream stream(path, std::ios::binary | std::ios::trunc);
+	if (!stream)
+	{
+		std::cout << "Failed to write '" << path << "'!" << std::endl;
+		return false;
+	}
+	stream.write((const char*)data.data(), data.size());
+	for (const std::vector<unsigned char>& level : image.Levels)
+		stream.write((const char*)level.data(), level.size());
+	return (bool)stream;
+}
+
+bool TextureContainer::IsContainer(const std::string& path)
+{
+	std::string extension = GetExtension(path);
+	return extension == "dds" || extension == "ktx2";
+}
+
+bool TextureContainer::IsSupported(CompressedFormat format)
+{
+	switch (format)
+	{
+	case CompressedFormat::BC1:
+	case CompressedFormat::BC3:
+		return GLEW_EXT_texture_compression_s3tc;
+	case CompressedFormat::BC4:
+	case CompressedFormat::BC5:
+		return GLEW_VERSION_3_0 || GLEW_ARB_texture_compression_rgtc;
+	case CompressedFormat::BC7:
+		return GLEW_VERSION_4_2 || GLEW_ARB_texture_compression_bptc;
+	default:
+		return GLEW_VERSION_4_3 || GLEW_ARB_ES3_compatibility;
+	}
+}
+
+unsigned int TextureContainer::GetInternalFormat(CompressedFormat format)
+{
+	return s_Formats[(unsigned int)format].InternalFormat;
+}
+
+unsigned int TextureContainer::GetBlockBytes(CompressedFormat format)
+{
+	return s_Formats[(unsigned int)format].BlockBytes;
+}
+
+size_t TextureContainer::GetLevelSize(CompressedFormat format, int width, int height)
+{
+	return (size_t)((width + 3) / 4) * ((height + 3) / 4) * GetBlockBytes(format);
+}
+
+const char* TextureContainer::GetName(CompressedFormat format)
+{
+	return s_Formats[(unsigned int)format].Name;
+}
+
+bool TextureContainer::ParseName(const std::string& name, CompressedFormat& format)
+{
+	for (unsigned int i = 0; i < (unsigned int)CompressedFormat::Count; i++)
+	{
+		if (name == s_Formats[i].Name)
+		{
+			format = (CompressedFormat)i;
+			return true;
+		}
+	}
+	return false;
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include "GLPrerequisites.h"
+
+#include <string>
+#include <vector>
+
+enum class CompressedFormat // Linear (not sRGB) block formats, 4x4 texels a block
+{
+	BC1, // RGB 8 bytes, 1 bit alpha at most (DXT1)
+	BC3, // RGBA 16 bytes, BC1 colour and BC4 alpha (DXT5)
+	BC4, // R 8 bytes, samples as (r, 0, 0, 1)
+	BC5, // RG 16 bytes, two BC4 blocks, for normal maps
+	BC7, // RGBA 16 bytes, much better than BC1/BC3 at the same rate as BC3, GL 4.2
+	ETC2_RGB8, // 8 bytes, GL 4.3 / ES 3.0, most desktop drivers decode it to RGBA8 on upload
+	ETC2_RGBA8, // 16 bytes
+	EAC_R11, // 8 bytes
+	EAC_RG11, // 16 bytes
+	Count
+};
+
+struct CompressedImage
+{
+	CompressedFormat Format = CompressedFormat::BC1;
+	int Width = 0, Height = 0;
+	std::vector<std::vector<unsigned char>> Levels; // Level 0 first, each GetLevelSize bytes of blocks
+};
+
+/*
+Reads and writes block compressed images with their prebuilt mip chains, see Texture(const CompressedImage&)
+to upload one. Loads DDS (DXT1/DXT5/ATI1/ATI2 FourCCs or a DX10 header) and uncompressed KTX2 (no Basis or
+zstd supercompression), single 2D images only. Saves DDS with a DX10 header, which is what the
+CompressTextures build target writes (see TextureCompressor).
+
+Blocks go to GL as stored, so the first block row is the bottom of the texture like every other Texture.
+TextureCompressor writes them that way round, files from other tools need exporting flipped vertically.
+
+    CompressedImage image;
+    TextureContainer::Load("res/textures/compressed/GojoTexture256x256.dds", image);
+    Texture gojo(image); // Texture("....dds") does the same
+*/
+class TextureContainer
+{
+private:
+	TextureContainer() {} // Static only
+public:
+	static bool Load(const std::string& path, CompressedImage& image); // By extension, .dds or .ktx2
+	static bool LoadDDS(const std::string& path, CompressedImage& image);
+	static bool LoadKTX2(const std::string& path, CompressedImage& image);
+	static bool SaveDDS(const std::string& path, const CompressedImage& image); // BC formats only, DDS has no ETC2
+
+	static bool IsContainer(const std::string& path); // Has a .dds or .ktx2 extension
+	static bool IsSupported(CompressedFormat format); // By the current context, after glewInit
+	static unsigned int GetInternalFormat(CompressedFormat format); // For glCompressedTexImage2D
+	static unsigned int GetBlockBytes(CompressedFormat format);
+	static size_t GetLevelSize(CompressedFormat format, int width, int height); // Partial blocks at the edges count whole
+	static const char* GetName(CompressedFormat format);
+	static bool ParseName(const std::string& name, CompressedFormat& format); // "BC7" and so on, as GetName gives
+};
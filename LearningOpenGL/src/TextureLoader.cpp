@@ -0,0 +1,183 @@
+#include "TextureLoader.h"
+
+#include "stb_image.h"
+
+#include "CPUProfiler.h"
+#include "GLState.h"
+
+#include <algorithm>
+#include <iostream>
+
+static const unsigned int s_Placeholder[4] = { 0xff808080, 0xff808080, 0xff808080, 0xff808080 }; // 2x2 mid grey
+
+TextureLoader::TextureLoader(unsigned int bytesPerPoll, unsigned int threadCount)
+	: m_Pending(0), m_BytesPerPoll(bytesPerPoll), m_Placeholder(2, 2, s_Placeholder), m_UploadBuffer(GL_PIXEL_UNPACK_BUFFER, bytesPerPoll), m_Stop(false)
+{
+	GLState::BindBuffer(GL_PIXEL_UNPACK_BUFFER, 0); // Left bound by the RingBuffer, every other texture upload would read from it
+
+	if (threadCount == 0)
+		threadCount = std::max(std::thread::hardware_concurrency(), 2u) - 1; // The GL thread has its own work
+	for (unsigned int i = 0; i < threadCount; i++)
+		m_Workers.emplace_back(&TextureLoader::WorkerLoop, this);
+}
+
+TextureLoader::~TextureLoader()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		m_Stop = true;
+	}
+	m_WorkAvailable.notify_all();
+	for (std::thread& worker : m_Workers)
+		worker.join();
+
+	for (Decoded& decoded : m_Decoded) // Finished but never polled
+		stbi_image_free(decoded.Pixels);
+	for (Job& job : m_Jobs)
+		stbi_image_free(job.Pixels);
+}
+
+TextureHandle TextureLoader::Submit(const std::string& path)
+{
+	TextureHandle handle;
+	handle.Index = (unsigned int)m_Jobs.size();
+
+	m_Jobs.emplace_back();
+	m_Jobs.back().FilePath = path;
+	m_Pending++;
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		m_Queue.emplace_back(handle.Index, path);
+	}
+	m_WorkAvailable.notify_one();
+	return handle;
+}
+
+void TextureLoader::WorkerLoop()
+{
+	stbi_set_flip_vertically_on_load_thread(1); // Same orientation as Texture, without racing on the global flag
+	while (true)
+	{
+		std::pair<unsigned int, std::string> work;
+		{
+			std::unique_lock<std::mutex> lock(m_Mutex);
+			m_WorkAvailable.wait(lock, [this]() { return m_Stop || !m_Queue.empty(); });
+			if (m_Stop)
+				return;
+			work = std::move(m_Queue.front());
+			m_Queue.pop_front();
+		}
+
+		Decoded decoded = { work.first, nullptr, 0, 0 };
+		{
+			PROFILE_SCOPE("Texture Decode");
+			int bpp = 0;
+			decoded.Pixels = stbi_load(work.second.c_str(), &decoded.Width, &decoded.Height, &bpp, 4);
+		}
+
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		m_Decoded.push_back(decoded);
+	}
+}
+
+unsigned int TextureLoader::Poll()
+{
+	PROFILE_FUNCTION();
+	std::vector<Decoded> decoded;
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		decoded.swap(m_Decoded);
+	}
+
+	for (const Decoded& image : decoded)
+	{
+		Job& job = m_Jobs[image.Index];
+		m_Stats.Decoded++;
+		if (!image.Pixels || (unsigned int)image.Width * 4 > m_BytesPerPoll) // A row has to fit in one poll's budget
+		{
+			std::cout << "Failed to load texture '" << job.FilePath << "'" << (image.Pixels ? ", its rows are wider than the upload budget" : "") << std::endl;
+			stbi_image_free(image.Pixels);
+			job.Status = TextureStatus::Failed;
+			m_Pending--;
+			continue;
+		}
+
+		job.Pixels = image.Pixels;
+		job.Width = image.Width;
+		job.Height = image.Height;
+		job.Loaded = std::make_unique<Texture>(image.Width, image.Height, nullptr); // Storage only, the bands fill it in
+		m_Uploads.push_back(image.Index);
+	}
+
+	m_Stats.BytesLastPoll = 0;
+	if (m_Uploads.empty())
+		return m_Pending;
+
+	m_UploadBuffer.BeginFrame(); // Waits only if the GPU hasn't read this segment since FramesInFlight polls ago
+	unsigned int budget = m_BytesPerPoll;
+	GLState::BindBuffer(GL_PIXEL_UNPACK_BUFFER, m_UploadBuffer.GetRendererID());
+	Upload(budget);
+	GLState::BindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+	GLState::BindTexture(GL_TEXTURE_2D, 0);
+	m_UploadBuffer.EndFrame();
+
+	m_Stats.BytesLastPoll = m_BytesPerPoll - budget;
+	m_Stats.BytesUploaded += m_Stats.BytesLastPoll;
+	return m_Pending;
+}
+
+void TextureLoader::Upload(unsigned int& budget)
+{
+	PROFILE_SCOPE("Texture Upload");
+	while (!m_Uploads.empty())
+	{
+		Job& job = m_Jobs[m_Uploads.front()];
+		unsigned int rowSize = (unsigned int)job.Width * 4;
+		int rows = std::min(job.Height - job.RowsUploaded, (int)(budget / rowSize));
+		if (rows == 0) // Out of budget until the next poll
+			return;
+
+		RingAllocation allocation = m_UploadBuffer.Allocate(job.Pixels + (size_t)job.RowsUploaded * rowSize, rows * rowSize, 4);
+		GLState::BindTexture(GL_TEXTURE_2D, job.Loaded->GetRendererID());
+		GLCall(glTexSubImage2D(GL_TEXTURE_2D, 0, 0, job.RowsUploaded, job.Width, rows, GL_RGBA, GL_UNSIGNED_BYTE, (const void*)(uintptr_t)allocation.Offset)); // Offset into the bound unpack buffer
+		job.RowsUploaded += rows;
+		budget -= rows * rowSize;
+
+		if (job.RowsUploaded < job.Height)
+			continue;
+
+		stbi_image_free(job.Pixels);
+		job.Pixels = nullptr;
+		job.Status = TextureStatus::Ready;
+		m_Uploads.pop_front();
+		m_Pending--;
+		m_Stats.Uploaded++;
+	}
+}
+
+void TextureLoader::WaitAll()
+{
+	while (Poll() > 0)
+		std::this_thread::yield();
+}
+
+TextureStatus TextureLoader::GetStatus(TextureHandle handle) const
+{
+	if (!handle.IsValid() || handle.Index >= m_Jobs.size())
+		return TextureStatus::Failed;
+	return m_Jobs[handle.Index].Status;
+}
+
+const Texture& TextureLoader::Get(TextureHandle handle) const
+{
+	if (GetStatus(handle) != TextureStatus::Ready || !m_Jobs[handle.Index].Loaded)
+		return m_Placeholder;
+	return *m_Jobs[handle.Index].Loaded;
+}
+
+std::unique_ptr<Texture> TextureLoader::Take(TextureHandle handle)
+{
+	if (GetStatus(handle) != TextureStatus::Ready)
+		return nullptr;
+	return std::move(m_Jobs[handle.Index].Loaded); // Leaves nullptr behind, so a second Take gets nothing
+}
@@ -0,0 +1,104 @@
+#pragma once
+
+#include "GLPrerequisites.h"
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "RingBuffer.h"
+#include "Texture.h"
+
+enum class TextureStatus
+{
+	Pending, Ready, Failed
+};
+
+struct TextureHandle
+{
+	unsigned int Index = 0xFFFFFFFF;
+
+	inline bool IsValid() const { return Index != 0xFFFFFFFF; }
+};
+
+struct TextureLoaderStats
+{
+	unsigned int Decoded = 0;
+	unsigned int Uploaded = 0; // Textures that became Ready
+	unsigned int BytesLastPoll = 0;
+	uint64_t BytesUploaded = 0;
+};
+
+/*
+Loads textures without stalling the frame. Submit queues the file for a pool of worker threads that run
+stbi_load, Poll (once a frame, on the GL thread) picks up finished decodes and uploads them. Uploads go
+through a ring of pixel unpack buffers (see RingBuffer) with glTexSubImage2D, a band of rows at a time,
+and stop once 'bytesPerPoll' have been copied, so a big texture is spread over several frames instead of
+hitching one.
+
+Until a texture is Ready, Get returns a small grey placeholder, so drawing can start straight away and
+pick the real texture up on a later frame. Failed loads keep the placeholder.
+
+    TextureHandle gojo = loader.Submit("res/textures/GojoTexture256x256.png");
+    ...
+    loader.Poll(); // Every frame
+    loader.Get(gojo).Bind(0);
+*/
+class TextureLoader
+{
+private:
+	struct Job
+	{
+		std::string FilePath;
+		std::unique_ptr<Texture> Loaded; // Created when the upload starts, only handed out once Ready
+		unsigned char* Pixels = nullptr; // Decoded RGBA8, freed after the last band
+		int Width = 0, Height = 0;
+		int RowsUploaded = 0;
+		TextureStatus Status = TextureStatus::Pending;
+	};
+
+	struct Decoded // Worker to GL thread
+	{
+		unsigned int Index;
+		unsigned char* Pixels; // nullptr if stbi_load failed
+		int Width, Height;
+	};
+
+	std::vector<Job> m_Jobs; // Indexed by TextureHandle, GL thread only
+	std::deque<unsigned int> m_Uploads; // Jobs decoded and waiting for (more) bands, in order
+	unsigned int m_Pending;
+	unsigned int m_BytesPerPoll;
+	Texture m_Placeholder; // Before m_UploadBuffer, which leaves itself bound for unpacking
+	RingBuffer m_UploadBuffer;
+	TextureLoaderStats m_Stats;
+
+	// Shared with the workers
+	std::vector<std::thread> m_Workers;
+	std::mutex m_Mutex;
+	std::condition_variable m_WorkAvailable;
+	std::deque<std::pair<unsigned int, std::string>> m_Queue;
+	std::vector<Decoded> m_Decoded;
+	bool m_Stop;
+public:
+	TextureLoader(unsigned int bytesPerPoll = 4 * 1024 * 1024, unsigned int threadCount = 0); // 0 uses all but one hardware thread
+	~TextureLoader();
+
+	TextureHandle Submit(const std::string& path);
+	unsigned int Poll(); // Returns how many textures are still pending
+	void WaitAll();
+
+	TextureStatus GetStatus(TextureHandle handle) const;
+	const Texture& Get(TextureHandle handle) const; // The placeholder until Ready, and again once taken
+	std::unique_ptr<Texture> Take(TextureHandle handle); // The finished Texture, once. nullptr if it isn't Ready or was already taken
+
+	inline unsigned int GetPendingCount() const { return m_Pending; }
+	inline const TextureLoaderStats& GetStats() const { return m_Stats; }
+private:
+	void WorkerLoop();
+	void Upload(unsigned int& budget);
+};
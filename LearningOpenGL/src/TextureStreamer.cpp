@@ -0,0 +1,219 @@
+#include "TextureStreamer.h"
+
+#include "stb_image.h"
+
+#include "CPUProfiler.h"
+#include "GLState.h"
+#include "MipChain.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+static const unsigned int s_Placeholder = 0xff808080;
+
+TextureStreamer::TextureStreamer(const TextureStreamerSettings& settings)
+	: m_Settings(settings), m_Frame(0), m_Placeholder(1, 1, &s_Placeholder)
+{
+}
+
+TextureHandle TextureStreamer::Add(const std::string& path)
+{
+	int width = 0, height = 0, bpp = 0;
+	stbi_set_flip_vertically_on_load(1); // Same orientation as Texture
+	unsigned char* pixels;
+	{
+		PROFILE_SCOPE("Texture Decode");
+		pixels = stbi_load(path.c_str(), &width, &height, &bpp, 4);
+	}
+	if (!pixels)
+	{
+		std::cout << "Failed to load streamed texture '" << path << "'" << std::endl;
+		return TextureHandle();
+	}
+
+	TextureHandle handle = Add(width, height, pixels, path);
+	stbi_image_free(pixels);
+	return handle;
+}
+
+TextureHandle TextureStreamer::Add(int width, int height, const unsigned char* rgba, const std::string& name)
+{
+	PROFILE_FUNCTION();
+	TextureHandle handle;
+	handle.Index = (unsigned int)m_Textures.size();
+	m_Textures.emplace_back();
+	Streamed& texture = m_Textures.back();
+	texture.FilePath = name;
+
+	texture.Levels = MipChain::Build(width, height, rgba);
+	int last = (int)texture.Levels.size() - 1;
+
+	while (texture.TailLevel < last && std::max(width >> texture.TailLevel, height >> texture.TailLevel) > m_Settings.TailSize)
+		texture.TailLevel++;
+
+	// Coarsest first, then finer ones down to the tail, each one widening the BASE_LEVEL clamp
+	texture.Resident = std::make_unique<Texture>(width, height, last, texture.Levels[last].data());
+	texture.BaseLevel = last;
+	m_Stats.ResidentBytes += texture.Levels[last].size();
+	GLState::BindTexture(GL_TEXTURE_2D, texture.Resident->GetRendererID());
+	GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR));
+	while (texture.BaseLevel > texture.TailLevel)
+		UploadLevel(texture, texture.BaseLevel - 1);
+	GLState::BindTexture(GL_TEXTURE_2D, 0);
+
+	texture.WantedLevel = texture.TailLevel;
+	texture.LastUsed = m_Frame;
+	return handle;
+}
+
+void TextureStreamer::Touch(TextureHandle handle, float screenSize)
+{
+	if (!handle.IsValid() || handle.Index >= m_Textures.size())
+		return;
+
+	Streamed& texture = m_Textures[handle.Index];
+	int size = std::max(texture.Resident->GetWidth(), texture.Resident->GetHeight());
+	int level = screenSize >= (float)size ? 0 : (int)std::floor(std::log2((float)size / std::max(screenSize, 1.0f))); // Where one texel is about one pixel
+	level = std::min(level, texture.TailLevel);
+
+	if (texture.LastUsed != m_Frame)
+		texture.WantedLevel = level;
+	else
+		texture.WantedLevel = std::min(texture.WantedLevel, level);
+	texture.LastUsed = m_Frame;
+}
+
+void TextureStreamer::Update()
+{
+	PROFILE_FUNCTION();
+	if (m_Stats.ResidentBytes > m_Settings.BudgetBytes) // The budget was lowered
+		Evict(0, nullptr);
+
+	std::vector<unsigned int> requests;
+	for (unsigned int i = 0; i < m_Textures.size(); i++)
+	{
+		if (IsRequesting(m_Textures[i]))
+			requests.push_back(i);
+	}
+	std::sort(requests.begin(), requests.end(), [this](unsigned int a, unsigned int b) // Most recently used, then furthest from what it wants
+	{
+		const Streamed& first = m_Textures[a];
+		const Streamed& second = m_Textures[b];
+		if (first.LastUsed != second.LastUsed)
+			return first.LastUsed > second.LastUsed;
+		return first.BaseLevel - first.WantedLevel > second.BaseLevel - second.WantedLevel;
+	});
+
+	unsigned int uploaded = 0;
+	for (unsigned int index : requests)
+	{
+		Streamed& texture = m_Textures[index];
+		while (texture.BaseLevel > texture.WantedLevel)
+		{
+			unsigned int bytes = (unsigned int)texture.Levels[texture.BaseLevel - 1].size();
+			if (uploaded > 0 && uploaded + bytes > m_Settings.BytesPerUpdate)
+				break;
+			if (m_Stats.ResidentBytes + bytes > m_Settings.BudgetBytes && !Evict(bytes, &texture))
+				break; // Waits until something else is used less recently, smaller requests may still fit
+
+			GLState::BindTexture(GL_TEXTURE_2D, texture.Resident->GetRendererID());
+			UploadLevel(texture, texture.BaseLevel - 1);
+			uploaded += bytes;
+		}
+		if (uploaded >= m_Settings.BytesPerUpdate)
+			break;
+	}
+	if (uploaded > 0)
+		GLState::BindTexture(GL_TEXTURE_2D, 0);
+
+	m_Stats.PendingRequests = 0;
+	for (const Streamed& texture : m_Textures)
+		m_Stats.PendingRequests += IsRequesting(texture);
+	m_Stats.BytesLastUpdate = uploaded;
+	m_Frame++;
+}
+
+void TextureStreamer::UploadLevel(Streamed& texture, int level) // The texture must be bound
+{
+	int width = std::max(texture.Resident->GetWidth() >> level, 1), height = std::max(texture.Resident->GetHeight() >> level, 1);
+	{
+		PROFILE_SCOPE("Texture Upload");
+		GLCall(glTexImage2D(GL_TEXTURE_2D, level, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, texture.Levels[level].data()));
+	}
+	GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, level)); // Only once the level is there, or the texture is incomplete. MAX_LEVEL stays on the coarsest
+
+	texture.BaseLevel = level;
+	m_Stats.ResidentBytes += texture.Levels[level].size();
+	m_Stats.LevelsUploaded++;
+}
+
+bool TextureStreamer::Evict(uint64_t bytes, const Streamed* requester)
+{
+	unsigned int recent = requester ? requester->LastUsed : m_Frame; // Anything used this recently is off limits, unless it has more than it asked for
+	auto evictable = [&](const Streamed& texture) { return &texture != requester && texture.BaseLevel < texture.TailLevel && (texture.BaseLevel < texture.WantedLevel || texture.LastUsed < recent); };
+
+	uint64_t available = 0; // Check it can be done at all first, so a request that won't fit doesn't throw levels away for nothing
+	for (const Streamed& texture : m_Textures)
+	{
+		if (!evictable(texture))
+			continue;
+		for (int level = texture.BaseLevel; level < texture.TailLevel; level++)
+			available += texture.Levels[level].size();
+	}
+	if (requester && m_Stats.ResidentBytes + bytes > m_Settings.BudgetBytes + available)
+		return false;
+
+	while (m_Stats.ResidentBytes + bytes > m_Settings.BudgetBytes)
+	{
+		Streamed* victim = nullptr;
+		bool victimOver = false;
+		for (Streamed& texture : m_Textures)
+		{
+			if (!evictable(texture))
+				continue;
+
+			bool over = texture.BaseLevel < texture.WantedLevel;
+			if (!victim || (over && !victimOver) || (over == victimOver && texture.LastUsed < victim->LastUsed))
+			{
+				victim = &texture;
+				victimOver = over;
+			}
+		}
+		if (!victim)
+			return false; // Only when trimming to a lowered budget, the tails can't go
+		EvictLevel(*victim);
+	}
+	return true;
+}
+
+bool TextureStreamer::IsRequesting(const Streamed& texture) const
+{
+	return texture.LastUsed == m_Frame && texture.BaseLevel > texture.WantedLevel; // Textures not touched this frame keep what they have but don't ask for more
+}
+
+void TextureStreamer::EvictLevel(Streamed& texture)
+{
+	int level = texture.BaseLevel;
+	GLState::BindTexture(GL_TEXTURE_2D, texture.Resident->GetRendererID());
+	GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, level + 1)); // Clamp first, so the texture never samples a level that's gone
+	GLCall(glTexImage2D(GL_TEXTURE_2D, level, GL_RGBA8, 0, 0, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr)); // Drops the level's storage
+
+	texture.BaseLevel = level + 1;
+	m_Stats.ResidentBytes -= texture.Levels[level].size();
+	m_Stats.LevelsEvicted++;
+}
+
+const Texture& TextureStreamer::Get(TextureHandle handle) const
+{
+	if (!handle.IsValid() || handle.Index >= m_Textures.size())
+		return m_Placeholder;
+	return *m_Textures[handle.Index].Resident;
+}
+
+int TextureStreamer::GetResidentLevel(TextureHandle handle) const
+{
+	if (!handle.IsValid() || handle.Index >= m_Textures.size())
+		return 0;
+	return m_Textures[handle.Index].BaseLevel;
+}
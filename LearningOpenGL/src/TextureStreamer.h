@@ -0,0 +1,88 @@
+#pragma once
+
+#include "GLPrerequisites.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "Texture.h"
+#include "TextureLoader.h"
+
+struct TextureStreamerSettings
+{
+	uint64_t BudgetBytes = 64ull * 1024 * 1024; // Resident mip levels of every streamed texture together
+	unsigned int BytesPerUpdate = 4 * 1024 * 1024; // Uploaded per Update, one level always goes through even if it is bigger
+	int TailSize = 64; // Levels this size or smaller are uploaded by Add and never evicted
+};
+
+struct TextureStreamerStats
+{
+	uint64_t ResidentBytes = 0;
+	unsigned int PendingRequests = 0; // Textures touched in the last frame still wanting finer levels than they have
+	unsigned int LevelsUploaded = 0;
+	unsigned int LevelsEvicted = 0;
+	unsigned int BytesLastUpdate = 0;
+};
+
+/*
+Streams mip levels of textures in and out to stay inside a memory budget. Add keeps the whole mip chain
+in system memory but uploads only the small levels (the tail), so everything is drawable at once at
+low resolution. Each frame the caller reports how big a texture is on screen with Touch, and Update
+uploads the next finer level of the textures that need it, coarse to fine, most recently used first.
+
+When the budget would be exceeded, levels are evicted from textures showing more detail than their
+last Touch asked for first, then from the least recently used ones. Nothing used at least as recently
+as the texture being streamed in gets evicted for it, that request waits instead.
+
+Resident levels are clamped with GL_TEXTURE_BASE_LEVEL / GL_TEXTURE_MAX_LEVEL, so a texture is always
+complete whatever is loaded. An evicted level is respecified as 0x0 to give its memory back.
+
+    TextureHandle ground = streamer.Add("res/textures/Ground.png");
+    streamer.Touch(ground, 300.0f); // Covers about 300 pixels this frame
+    streamer.Update();
+    streamer.Get(ground).Bind(0);
+*/
+class TextureStreamer
+{
+private:
+	struct Streamed
+	{
+		std::string FilePath;
+		std::unique_ptr<Texture> Resident;
+		std::vector<std::vector<unsigned char>> Levels; // RGBA8 bottom row first, level 0 is full size
+		int TailLevel = 0; // Coarsest level that is bigger than the tail, everything from here down stays
+		int BaseLevel = 0; // Finest level resident
+		int WantedLevel = 0; // From the last Touch
+		unsigned int LastUsed = 0; // Frame of the last Touch
+	};
+
+	TextureStreamerSettings m_Settings;
+	std::vector<Streamed> m_Textures; // Indexed by TextureHandle
+	unsigned int m_Frame;
+	Texture m_Placeholder; // For handles Add failed to make
+	TextureStreamerStats m_Stats;
+public:
+	TextureStreamer(const TextureStreamerSettings& settings = TextureStreamerSettings());
+
+	TextureHandle Add(const std::string& path); // Decodes and builds the mip chain right away, an invalid handle if the file can't be read
+	TextureHandle Add(int width, int height, const unsigned char* rgba, const std::string& name = "");
+
+	void Touch(TextureHandle handle, float screenSize); // Pixels it covers along its longer side, the largest of the frame wins
+	void Update(); // Once a frame, after the Touches
+
+	const Texture& Get(TextureHandle handle) const;
+	int GetResidentLevel(TextureHandle handle) const; // Finest level resident, 0 is full resolution
+
+	inline void SetBudget(uint64_t bytes) { m_Settings.BudgetBytes = bytes; } // Shrinking it evicts on the next Update
+	inline const TextureStreamerSettings& GetSettings() const { return m_Settings; }
+	inline const TextureStreamerStats& GetStats() const { return m_Stats; }
+	inline uint64_t GetResidentBytes() const { return m_Stats.ResidentBytes; }
+	inline unsigned int GetPendingRequests() const { return m_Stats.PendingRequests; }
+private:
+	void UploadLevel(Streamed& texture, int level);
+	bool Evict(uint64_t bytes, const Streamed* requester); // Makes room for 'bytes' more, nullptr to only get back under the budget
+	void EvictLevel(Streamed& texture);
+	bool IsRequesting(const Streamed& texture) const;
+};
@@ -0,0 +1,67 @@
+#pragma once
+
+#include "Std140.h"
+
+#include "glm.hpp"
+
+/*
+Uniform blocks shared by every program. Each has a fixed binding point, Shader points any active block
+with a matching name at it after linking, so one UniformBuffer per block serves all programs. The
+GLSL side is declared as
+
+    layout(std140) uniform Camera
+    {
+        mat4 u_ViewProjection;
+        ...
+    };
+*/
+enum class UniformBinding : unsigned int
+{
+	Camera = 0, Frame = 1, Draw = 2
+};
+
+struct CameraBlock // "Camera"
+{
+	glm::mat4 ViewProjection;
+	glm::mat4 View;
+	glm::mat4 Projection;
+	glm::vec4 Position; // w unused
+};
+STD140_MEMBER(CameraBlock, ViewProjection);
+STD140_MEMBER(CameraBlock, View);
+STD140_MEMBER(CameraBlock, Projection);
+STD140_MEMBER(CameraBlock, Position);
+STD140_SIZE(CameraBlock);
+
+struct FrameBlock // "Frame"
+{
+	float Time; // Seconds since start
+	float DeltaTime;
+	glm::vec2 Resolution; // Pixels
+};
+STD140_MEMBER(FrameBlock, Time);
+STD140_MEMBER(FrameBlock, DeltaTime);
+STD140_MEMBER(FrameBlock, Resolution);
+STD140_SIZE(FrameBlock);
+
+static const unsigned int MaxDrawBlocks = 128; // Length of the u_Draws array in the "Draw" block, 12KB fits the 16KB minimum block size
+
+struct DrawBlock // One element of the "Draw" block's u_Draws array, one per draw call, streamed through a RingBuffer
+{
+	glm::mat4 Model;
+	glm::vec4 Color;
+	glm::ivec4 Material; // x is the material index, the rest is free
+};
+STD140_MEMBER(DrawBlock, Model);
+STD140_MEMBER(DrawBlock, Color);
+STD140_MEMBER(DrawBlock, Material);
+STD140_SIZE(DrawBlock);
+
+struct UniformBlockInfo
+{
+	const char* Name; // Block name in GLSL
+	UniformBinding Binding;
+	unsigned int Size; // Of the C++ side, checked against GL_UNIFORM_BLOCK_DATA_SIZE
+};
+
+const UniformBlockInfo* FindUniformBlock(const char* name); // nullptr for blocks that aren't shared
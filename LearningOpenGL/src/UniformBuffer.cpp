@@ -0,0 +1,60 @@
+#include "UniformBuffer.h"
+
+#include "GLState.h"
+
+#include <cstring>
+
+static const UniformBlockInfo s_UniformBlocks[] =
+{
+    { "Camera", UniformBinding::Camera, sizeof(CameraBlock) },
+    { "Frame",  UniformBinding::Frame,  sizeof(FrameBlock) },
+    { "Draw",   UniformBinding::Draw,   sizeof(DrawBlock) * MaxDrawBlocks },
+};
+
+const UniformBlockInfo* FindUniformBlock(const char* name)
+{
+    for (const UniformBlockInfo& block : s_UniformBlocks)
+    {
+        if (std::strcmp(block.Name, name) == 0)
+            return &block;
+    }
+    return nullptr;
+}
+
+UniformBuffer::UniformBuffer(unsigned int size, UniformBinding binding)
+    : m_RendererID(0), m_Size(size), m_Binding((unsigned int)binding)
+{
+    GLCall(glGenBuffers(1, &m_RendererID));
+    GLState::BindBuffer(GL_UNIFORM_BUFFER, m_RendererID);
+    GLCall(glBufferData(GL_UNIFORM_BUFFER, size, nullptr, GL_DYNAMIC_DRAW));
+    BindBase();
+}
+
+UniformBuffer::~UniformBuffer()
+{
+    GLCall(glDeleteBuffers(1, &m_RendererID));
+    GLState::OnBufferDeleted(m_RendererID);
+}
+
+void UniformBuffer::Bind() const
+{
+    GLState::BindBuffer(GL_UNIFORM_BUFFER, m_RendererID);
+}
+
+void UniformBuffer::BindBase() const
+{
+    GLState::BindBufferBase(GL_UNIFORM_BUFFER, m_Binding, m_RendererID);
+}
+
+void UniformBuffer::SetData(const void* data, unsigned int size, unsigned int offset)
+{
+    Bind();
+    if (offset == 0 && size == m_Size)
+    {
+        GLCall(glBufferData(GL_UNIFORM_BUFFER, size, data, GL_DYNAMIC_DRAW));
+    }
+    else
+    {
+        GLCall(glBufferSubData(GL_UNIFORM_BUFFER, offset, size, data));
+    }
+}
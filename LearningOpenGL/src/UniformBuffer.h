@@ -0,0 +1,27 @@
+#pragma once
+
+#include "GLPrerequisites.h"
+
+#include "UniformBlocks.h"
+
+class UniformBuffer
+{
+private:
+	unsigned int m_RendererID;
+	unsigned int m_Size;
+	unsigned int m_Binding;
+public:
+	UniformBuffer(unsigned int size, UniformBinding binding); // Stays attached to 'binding' for its whole life
+	~UniformBuffer();
+
+	void Bind() const;
+	void BindBase() const; // Only needed if something else took the binding point
+
+	void SetData(const void* data, unsigned int size, unsigned int offset = 0); // A full update orphans the old storage instead of waiting for the GPU to finish with it
+	template<typename T>
+	void Set(const T& block) { SetData(&block, sizeof(T)); }
+
+	inline unsigned int GetRendererID() const { return m_RendererID; }
+	inline unsigned int GetSize() const { return m_Size; }
+	inline unsigned int GetBinding() const { return m_Binding; }
+};
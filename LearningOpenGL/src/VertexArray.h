@@ -9,12 +9,15 @@ class VertexArray
 {
 private:
 	unsigned int m_RendererID;
+	unsigned int m_AttribCount; // Next free attribute index, so a second (e.g. per-instance) buffer carries on after the first
 public:
 	VertexArray();
 	~VertexArray();
 
 	void AddBuffer(const VertexBuffer& vb, const VertexBufferLayout& layout);
 
+	inline unsigned int GetAttribCount() const { return m_AttribCount; }
+
 	void Bind() const;
 	void Unbind() const;
 };
\ No newline at end of file
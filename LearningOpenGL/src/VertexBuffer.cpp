@@ -1,23 +1,41 @@
 #include "VertexBuffer.h"
 
+#include "CPUProfiler.h"
+#include "GLState.h"
+
 VertexBuffer::VertexBuffer(const void* data, unsigned int size)
 {
     GLCall(glGenBuffers(1, &m_RendererID));
-    GLCall(glBindBuffer(GL_ARRAY_BUFFER, m_RendererID)); // Binds a buffer object ID to the specified buffer binding point
+    GLState::BindBuffer(GL_ARRAY_BUFFER, m_RendererID); // Binds a buffer object ID to the specified buffer binding point
     GLCall(glBufferData(GL_ARRAY_BUFFER, size, data, GL_STATIC_DRAW)); // Pushes data
 }
 
+VertexBuffer::VertexBuffer(unsigned int size)
+{
+    GLCall(glGenBuffers(1, &m_RendererID));
+    GLState::BindBuffer(GL_ARRAY_BUFFER, m_RendererID);
+    GLCall(glBufferData(GL_ARRAY_BUFFER, size, nullptr, GL_DYNAMIC_DRAW)); // Allocates storage only, no data is pushed yet
+}
+
 VertexBuffer::~VertexBuffer()
 {
     GLCall(glDeleteBuffers(1, &m_RendererID));
+    GLState::OnBufferDeleted(m_RendererID);
 }
 
 void VertexBuffer::Bind() const
 {
-    GLCall(glBindBuffer(GL_ARRAY_BUFFER, m_RendererID));
+    GLState::BindBuffer(GL_ARRAY_BUFFER, m_RendererID);
 }
 
 void VertexBuffer::Unbind() const
 {
-    GLCall(glBindBuffer(GL_ARRAY_BUFFER, 0));
+    GLState::BindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void VertexBuffer::SetData(const void* data, unsigned int size, unsigned int offset)
+{
+    PROFILE_FUNCTION();
+    Bind();
+    GLCall(glBufferSubData(GL_ARRAY_BUFFER, offset, size, data)); // Overwrites part of the existing storage
 }
@@ -8,8 +8,11 @@ private:
 	unsigned int m_RendererID;
 public:
 	VertexBuffer(const void* data, unsigned int size);
+	VertexBuffer(unsigned int size); // Dynamic buffer, filled later with SetData
 	~VertexBuffer();
 
+	void SetData(const void* data, unsigned int size, unsigned int offset = 0);
+
 	void Bind() const;
 	void Unbind() const;
 };
\ No newline at end of file
@@ -5,11 +5,14 @@
 #include <vector>
 #include <stdexcept>
 
+#include "glm.hpp"
+
 struct VertexBufferElement
 {
 	unsigned int type;
 	unsigned int count;
 	unsigned char normalized;
+	unsigned int divisor; // 0 = per vertex, N = advances once every N instances
 
 	static unsigned int GetSizeOfType(unsigned int type)
 	{
@@ -34,28 +37,34 @@ public:
 		: m_Stride(0) {}
 
 	template<typename T>
-	void Push(unsigned int count) {
+	void Push(unsigned int count, unsigned int divisor = 0) {
 		std::runtime_error(false);
 	}
 
 	template<>
-	void Push<float>(unsigned int count) {
-		m_Elements.push_back({ GL_FLOAT, count, GL_FALSE });
+	void Push<float>(unsigned int count, unsigned int divisor) {
+		m_Elements.push_back({ GL_FLOAT, count, GL_FALSE, divisor });
 		m_Stride += count * VertexBufferElement::GetSizeOfType(GL_FLOAT);
 	}
 
 	template<>
-	void Push<unsigned int>(unsigned int count) {
-		m_Elements.push_back({ GL_UNSIGNED_INT, count, GL_FALSE });
+	void Push<unsigned int>(unsigned int count, unsigned int divisor) {
+		m_Elements.push_back({ GL_UNSIGNED_INT, count, GL_FALSE, divisor });
 		m_Stride += count * VertexBufferElement::GetSizeOfType(GL_UNSIGNED_INT);
 	}
 
 	template<>
-	void Push<unsigned char>(unsigned int count) {
-		m_Elements.push_back({ GL_UNSIGNED_BYTE, count, GL_TRUE });
+	void Push<unsigned char>(unsigned int count, unsigned int divisor) {
+		m_Elements.push_back({ GL_UNSIGNED_BYTE, count, GL_TRUE, divisor });
 		m_Stride += count * VertexBufferElement::GetSizeOfType(GL_UNSIGNED_BYTE);
 	}
 
+	template<>
+	void Push<glm::mat4>(unsigned int count, unsigned int divisor) { // A mat4 attribute takes up 4 consecutive vec4 locations
+		for (unsigned int i = 0; i < count * 4; i++)
+			Push<float>(4, divisor);
+	}
+
 	inline const std::vector<VertexBufferElement> GetElements() const { return m_Elements; }
 	inline unsigned int GetStride() const { return m_Stride; }
 };
\ No newline at end of file